@@ -32,19 +32,27 @@ SOFTWARE.
 #include "zhLogger.h"
 #include "zhAllocObj.h"
 #include "zhMemoryPool.h"
+#include "zhScratchArena.h"
 #include "zhFunctor.h"
+#include "zhThreadPool.h"
 #include "zhEvent.h"
+#include "zhEventQueue.h"
 #include "zhObjectFactory.h"
 #include "zhSmartPtr.h"
 #include "zhResourceManager.h"
 #include "zhMath.h"
 #include "zhAnimationSystem.h"
+#include "zhLODPolicy.h"
+#include "zhCharacter.h"
 #include "zhAnimationManager.h"
 #include "zhAnimationSet.h"
 #include "zhAnimation.h"
 #include "zhAnimationSpace.h"
 #include "zhAnimationTrack.h"
 #include "zhBoneAnimationTrack.h"
+#include "zhMoverCurve.h"
+#include "zhBoneMask.h"
+#include "zhPose.h"
 #include "zhAnimationSpace.h"
 #include "zhZHALoader.h"
 #include "zhZHASerializer.h"
@@ -54,6 +62,7 @@ SOFTWARE.
 #include "zhAnimationBlendNode.h"
 #include "zhAnimationQueueNode.h"
 #include "zhAnimationAdaptor.h"
+#include "zhAnimationProgram.h"
 #include "zhRootIKSolver.h"
 #include "zhPostureIKSolver.h"
 #include "zhLimbIKSolver.h"
@@ -28,11 +28,14 @@ SOFTWARE.
 #include "zhAnimationSet.h"
 #include "zhAnimationAnnotation.h"
 #include "zhBoneAnimationTrack.h"
+#include "zhMoverCurve.h"
+#include "zhBoneMask.h"
 
 namespace zh
 {
 
 class Skeleton;
+class Pose;
 
 enum KFInterpolationMethod
 {
@@ -51,7 +54,7 @@ public:
 	typedef MapIterator< std::map<unsigned short, BoneAnimationTrack*> > BoneTrackIterator;
 	typedef MapConstIterator< std::map<unsigned short, BoneAnimationTrack*> > BoneTrackConstIterator;
 
-	static const std::set<unsigned short> EmptyBoneMask;
+	static const BoneMask EmptyBoneMask;
 
 	/**
 	* Constructor.
@@ -147,6 +150,35 @@ public:
 	*/
 	void setKFInterpolationMethod( KFInterpolationMethod interpMethod );
 
+	/**
+	* Builds the splines used for key-frame interpolation on all
+	* bone tracks. This should be called once key-frames are finalized,
+	* i.e. after the animation has been loaded or edited, since editing
+	* key-frames discards the splines of the affected tracks.
+	*
+	* @remark Splines are not built lazily while sampling, so that
+	* an animation can be sampled concurrently from multiple threads.
+	* Until splines are rebuilt, edited tracks are interpolated linearly.
+	* The mover curve is rebuilt as well (see buildMoverCurve()).
+	*/
+	void buildInterpSplines();
+
+	/**
+	* Builds the mover curve from the root bone track (track 0),
+	* sampled at the animation frame rate.
+	*
+	* @remark This function is called by buildInterpSplines().
+	*/
+	void buildMoverCurve();
+
+	/**
+	* Gets the precomputed root motion of this animation.
+	*
+	* @return Pointer to the mover curve, or NULL if the curve hasn't
+	* been built or the root track has been edited since.
+	*/
+	const MoverCurve* getMoverCurve() const;
+
 	/**
 	* Gets the length of this animation.
 	*/
@@ -173,9 +205,35 @@ public:
 	* @param weight Blend weight with which this animation should be applied.
 	* @param scale Scaling factor applied to this animation.
 	* @param boneMask Bone mask. Animation is not applied to masked bones.
+	* @param cursor Playback cursor used for key-frame lookup or NULL.
+	* Callers that sample the animation at (mostly) increasing times
+	* should keep a cursor to avoid searching the tracks.
 	*/
 	void apply( Skeleton* skel, float time, float weight = 1.f, float scale = 1.f,
-		const std::set<unsigned short> boneMask = EmptyBoneMask ) const;
+		const BoneMask& boneMask = EmptyBoneMask, KeyFrameCursor* cursor = NULL ) const;
+
+	/**
+	* Applies the animation to the specified skeleton.
+	*
+	* @remark This is a convenience overload which converts the bone mask
+	* into a BoneMask on each call. Prefer the BoneMask overload in per-frame code.
+	*/
+	void apply( Skeleton* skel, float time, float weight, float scale,
+		const std::set<unsigned short>& boneMask, KeyFrameCursor* cursor = NULL ) const;
+
+	/**
+	* Samples the animation into the specified pose. Unlike apply(),
+	* this does not modify any skeleton or allocate memory, so
+	* the same animation can be sampled concurrently into different poses.
+	* 
+	* @param time Time at which this animation should be sampled.
+	* @param pose Pose which receives bone transformations. Transformations
+	* of bones which are masked or not animated are left unchanged.
+	* @param boneMask Bone mask. Animation is not sampled for masked bones.
+	* @param cursor Playback cursor used for key-frame lookup or NULL.
+	*/
+	void sample( float time, Pose& pose, const BoneMask& boneMask = EmptyBoneMask,
+		KeyFrameCursor* cursor = NULL ) const;
 
 	/**
 	* Computes the axis-aligned bounding box of the root motion path in this
@@ -225,6 +283,9 @@ private:
 	KFInterpolationMethod mInterpMethod;
 	int mFrameRate;
 
+	MoverCurve mMoverCurve;
+	unsigned int mMoverCurveKFVersion; ///< Root track key-frame version the mover curve was built from.
+
 	TransitionAnnotationContainer* mTransAnnots;
 	ParamTransitionAnnotationContainer* mParamTransAnnots;
 	PlantConstraintAnnotationContainer* mPlantConstrAnnots;
@@ -102,8 +102,40 @@ public:
 	*/
 	void adapt( Skeleton* targetSkel );
 
+	/**
+	* Builds the retargetting map between the original skeleton
+	* and the specified target skeleton. The map is rebuilt automatically
+	* by adapt() whenever the target skeleton changes or either
+	* skeleton is modified, so this only needs to be called to avoid
+	* the rebuild cost on the first adapted frame.
+	*
+	* @param targetSkel Pointer to the target skeleton.
+	*/
+	void _buildRetargetMap( Skeleton* targetSkel );
+
 protected:
 
+	/**
+	* Correspondence between a bone on the original skeleton
+	* and a bone on the target skeleton.
+	*/
+	struct BoneMapping
+	{
+		unsigned int mOrigIndex; ///< Bone index in the original skeleton.
+		unsigned int mTargetIndex; ///< Bone index in the target skeleton.
+		bool mRoot; ///< If true, the target bone is the root and receives position as well.
+	};
+
+	/**
+	* End-effector tag resolved on both skeletons.
+	*/
+	struct EndEffectorMapping
+	{
+		unsigned int mOrigIndex; ///< End-effector bone index in the original skeleton.
+		unsigned short mTargetBoneId; ///< End-effector bone ID in the target skeleton.
+	};
+
+	bool _isRetargetMapValid( Skeleton* targetSkel ) const;
 	void _computeIKGoals( Skeleton* targetSkel ) const;
 	float _computeIKGoalWeight(Bone* endEff) const;
 	float _computeEnvObjDistance( Bone* endEff, Bone* envObj ) const;
@@ -116,6 +148,15 @@ protected:
 	float mEnvSens;
 	mutable std::map<std::pair<unsigned short, unsigned short>, float> mPrevEnvObjDist;
 	mutable std::map<unsigned short, float> mPrevGroundDist;
+
+	// retargetting map, valid for mRetargetSkel at the stored skeleton versions
+	Skeleton* mRetargetSkel;
+	unsigned int mOrigSkelVersion;
+	unsigned int mTargetSkelVersion;
+	std::vector<BoneMapping> mBoneMappings;
+	std::vector<EndEffectorMapping> mEndEffMappings;
+	std::vector<IKSolver*> mGoalSolvers; ///< Target IK solvers, each receives all end-effector goals.
+	mutable std::vector<IKGoal> mGoals;
 };
 
 }
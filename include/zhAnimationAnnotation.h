@@ -41,6 +41,8 @@ enum AnimationAnnotationClass
 	AnimAnnot_SimEvent
 };
 
+class AnimationAnnotationContainer;
+
 /**
 * @brief Base class for animation annotations.
 */
@@ -97,10 +99,22 @@ public:
 	*/
 	virtual void _clone( AnimationAnnotation* clonePtr ) const;
 
+	/**
+	* Gets the container which owns this annotation.
+	*/
+	AnimationAnnotationContainer* _getContainer() const;
+
+	/**
+	* Sets the container which owns this annotation.
+	* The container is notified when annotation times change.
+	*/
+	void _setContainer( AnimationAnnotationContainer* container );
+
 protected:
 
 	float mStartTime;
 	float mEndTime;
+	AnimationAnnotationContainer* mContainer;
 
 };
 
@@ -407,8 +421,33 @@ private:
 
 };
 
+/**
+* @brief Playback cursor for annotation queries.
+*
+* Remembers where in the annotation index the previous query ended,
+* so queries for consecutive time intervals don't need to search the index.
+*/
+struct AnnotationCursor
+{
+
+public:
+
+	AnnotationCursor() : mContainer(NULL), mIndexVersion(0), mStartPos(0), mEndPos(0) { }
+
+	const AnimationAnnotationContainer* mContainer; ///< Container of the last query.
+	unsigned int mIndexVersion; ///< Container index version at the last query.
+	unsigned int mStartPos; ///< Position in the start time index after the last query.
+	unsigned int mEndPos; ///< Position in the end time index after the last query.
+
+};
+
 /**
 * @brief Base class for animation annotation containers.
+*
+* Annotations are indexed by their start and end times, so annotations
+* which became active or finished over a time interval are found
+* in logarithmic time, or in constant time with an AnnotationCursor
+* when playback is continuous.
 */
 class zhDeclSpec AnimationAnnotationContainer
 {
@@ -501,10 +540,14 @@ public:
 	* @param countPassed If true, annotations that have been passed over
 	* (i.e. that start and end between prevTime and time)
 	* will be counted as well.
+	* @param cursor Playback cursor. If time intervals of
+	* consecutive queries are adjacent, the cursor makes
+	* the query run in constant time.
 	* @return Number of active annotations.
 	*/
 	virtual unsigned int getActiveAnnotations( float prevTime, float time,
-		std::vector<AnimationAnnotation*>& annots, bool countPassed = false ) const;
+		std::vector<AnimationAnnotation*>& annots, bool countPassed = false,
+		AnnotationCursor* cursor = NULL ) const;
 
 	/**
 	* Gets the list of animation annotations that are no longer active
@@ -516,10 +559,14 @@ public:
 	* @param countPassed If true, annotations that have been passed over
 	* (i.e. that start and end between prevTime and time)
 	* will be counted as well.
+	* @param cursor Playback cursor. If time intervals of
+	* consecutive queries are adjacent, the cursor makes
+	* the query run in constant time.
 	* @return Number of finished annotations.
 	*/
 	virtual unsigned int getFinishedAnnotations( float prevTime, float time,
-		std::vector<AnimationAnnotation*>& annots, bool countPassed = true ) const;
+		std::vector<AnimationAnnotation*>& annots, bool countPassed = true,
+		AnnotationCursor* cursor = NULL ) const;
 
 	/**
 	* Creates a deep copy of the annotation container.
@@ -528,13 +575,36 @@ public:
 	*/
 	virtual void _clone( AnimationAnnotationContainer* clonePtr ) const;
 
+	/**
+	* Removes the annotation from the time index.
+	* Called before annotation times change.
+	*/
+	void _removeFromIndex( AnimationAnnotation* annot );
+
+	/**
+	* Adds the annotation to the time index.
+	* Called after annotation times change.
+	*/
+	void _addToIndex( AnimationAnnotation* annot );
+
 protected:
 
 	virtual AnimationAnnotation* _createAnnotation( float startTime, float endTime ) = 0;
 	///< Actual annotation creation, implemented in concrete AnimationAnnotationContainer subclasses.
 
+	unsigned int _findIndexPosition( const std::vector<float>& times, float time,
+		bool after, unsigned int hint ) const;
+	///< Finds the first index position with time greater than (after == true) or not less than the specified time.
+
 	std::vector<AnimationAnnotation*> mAnnots;
 
+	// Time index
+	std::vector<float> mStartTimes; ///< Annotation start times, sorted.
+	std::vector<AnimationAnnotation*> mAnnotsByStart;
+	std::vector<float> mEndTimes; ///< Annotation end times, sorted.
+	std::vector<AnimationAnnotation*> mAnnotsByEnd;
+	unsigned int mIndexVersion; ///< Incremented whenever the index changes.
+
 };
 
 /**
@@ -60,6 +60,20 @@ public:
 	*/
 	bool isLeaf() const;
 
+	/**
+	* Adds a child node to this blend node. The child gets
+	* a blend weight of 0.
+	*
+	* @remark If the children match the base animations of the current
+	* animation space again, they are reordered by base animation index.
+	*/
+	void addChild( AnimationNode* node );
+
+	/**
+	* Removes all child nodes and their blend weights.
+	*/
+	void removeAllChildren();
+
 	// TODO: main child should be an AnimationSampleNode somewhere below this AnimationBlendNode in the tree
 	// maybe even the one with the highest blend weight?
 
@@ -236,6 +250,11 @@ public:
 	*/
 	virtual void setUseBlendCurves( bool useBlendCurves = true );
 
+	/**
+	* Gets the index of the blend weight of the specified child node.
+	*/
+	unsigned int _getBaseAnimationIndex( unsigned short nodeId ) const;
+
 	/**
 	* Samples this animation's mover channel at the current time.
 	*
@@ -274,7 +293,7 @@ protected:
 	* @param weight Blend weight.
 	* @param boneMask Bone mask. Animation is not applied to masked bones.
 	*/
-	void _applyNode( float weight = 1.f, const std::set<unsigned short>& boneMask = Animation::EmptyBoneMask ) const;
+	void _applyNode( float weight = 1.f, const BoneMask& boneMask = Animation::EmptyBoneMask ) const;
 
 	/**
 	* Initializes the interpolated annotations.
@@ -290,15 +309,30 @@ protected:
 	*/
 	virtual void _blendAnnotations();
 
+	/**
+	* Removes the specified node from the list of child nodes,
+	* along with its blend weight.
+	*/
+	void _eraseChild( AnimationNode* node );
+
+	/**
+	* Maps child nodes to base animations of the current animation space
+	* and reorders the children (and their weights) by base animation index.
+	*/
+	void _mapBaseAnimations();
+
 	void _getTWCurvePosition( float u, unsigned int& cpi, float& t ) const; ///< Compute position on the timewarp curve.
 
 	float mTWCurveTime; ///< Current time on the timewarp curve.
+	Vector mTWCurvePoint0, mTWCurvePoint; ///< Timewarp curve samples, kept to avoid reallocating them every frame.
+	Vector mAlignCurvePoint; ///< Alignment curve sample, kept to avoid reallocating it every frame.
 	Skeleton::Situation mOrigin;
 
 	AnimationSetPtr mAnimSet;
 	unsigned short mAnimSpaceId;
 	std::map<unsigned short, unsigned int> mChildrenToBaseAnims;
 	///< For each child node ID this map specifies the index of the corresponding base animation in the animation space.
+	///< Child nodes are also ordered by base animation index, so per-frame code needn't consult this map.
 	Vector mWeights;
 	Vector mParams;
 	bool mParamEnabled;
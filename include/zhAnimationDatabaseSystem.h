@@ -207,6 +207,32 @@ public:
 	*/
 	void setMaxBridgeLength( float maxBridgeLength = 1.f ) { mMaxBridgeLength = maxBridgeLength; }
 
+	/**
+	* Gets the number of threads building match webs in parallel
+	* while building an index.
+	*/
+	unsigned int getNumIndexThreads() const { return mNumIndexThreads; }
+
+	/**
+	* Sets the number of threads building match webs in parallel
+	* while building an index, including the calling thread
+	* (default value is 1, i.e. no parallelism).
+	*/
+	void setNumIndexThreads( unsigned int numThreads = 1 ) { mNumIndexThreads = numThreads; }
+
+	/**
+	* Gets the number of threads building each animation distance grid
+	* while building transitions.
+	*/
+	unsigned int getNumTransitionThreads() const { return mNumTransitionThreads; }
+
+	/**
+	* Sets the number of threads building each animation distance grid
+	* while building transitions, including the calling thread
+	* (default value is 1, i.e. no parallelism).
+	*/
+	void setNumTransitionThreads( unsigned int numThreads = 1 ) { mNumTransitionThreads = numThreads; }
+
 	/**
 	* Builds an index over the currently loaded animation data
 	* for efficient animation search.
@@ -506,6 +532,8 @@ private:
 	float mMaxDistDiff;
 	float mMinChainLength;
 	float mMaxBridgeLength;
+	unsigned int mNumIndexThreads;
+	unsigned int mNumTransitionThreads;
 
 	float mMaxOverlap;
 
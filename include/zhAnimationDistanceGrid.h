@@ -28,10 +28,13 @@ SOFTWARE.
 #include "zhSkeleton.h"
 #include "zhAnimationSegment.h"
 
+#define zhAnimationDistanceGrid_TileSize 64
+
 namespace zh
 {
 
 class Animation;
+class ThreadPool;
 
 /**
 * @brief Animation distance grid for comparing
@@ -186,6 +189,8 @@ public:
 	*
 	* @param wndLength Length of the animation window
 	* used in animation comparison.
+	* @param threadPool Pool of threads building the grid.
+	* If NULL, the grid is built on the calling thread.
 	* @remark When comparing a pair of sample frames,
 	* the distance computation algorithm takes into account
 	* not just character poses at those specific
@@ -195,7 +200,21 @@ public:
 	* It typically does not need to be longer than
 	* animation transition length.
 	*/
-	void build( float wndLength = 0.35 );
+	void build( float wndLength = 0.35, ThreadPool* threadPool = NULL );
+
+	/**
+	* Builds the animation distance grid only in the specified region.
+	*
+	* @param region Flags marking the grid points which should be computed,
+	* indexed by si1 + getNumSamples1() * si2. Other points are given
+	* the distance FLT_MAX and do not count towards
+	* the minimum and maximum distance.
+	* @param wndLength Length of the animation window
+	* used in animation comparison.
+	* @param threadPool Pool of threads building the grid.
+	* If NULL, the grid is built on the calling thread.
+	*/
+	void build( const std::vector<bool>& region, float wndLength = 0.35, ThreadPool* threadPool = NULL );
 
 	/**
 	* Gets a point in the distance grid.
@@ -228,6 +247,16 @@ public:
 	*/
 	float getNormDistance( const Index& index ) const;
 
+	/**
+	* Gets the minimum distance in the grid.
+	*/
+	float getMinDistance() const;
+
+	/**
+	* Gets the maximum distance in the grid.
+	*/
+	float getMaxDistance() const;
+
 	/**
 	* Sets the distance between two sample animation frames.
 	*
@@ -322,6 +351,7 @@ public:
 
 private:
 
+	void _build( float wndLength, ThreadPool* threadPool, const std::vector<bool>* region );
 	void _computeBoneWeights( Bone* bone );
 
 	typedef std::pair<unsigned int, unsigned int> MarkerIndex; ///< Index of a marker,
@@ -340,6 +370,7 @@ private:
 
 	float _computeOptimalPathSegment( const Index& srcIndex, const Index& dstIndex,
 		std::vector<Point>& path ) const;
+	void _annotateDTW( const Index& ptIndex, const Index& srcIndex, std::map<Index,_DTWAnnot>& dtwAnnots ) const;
 	_DTWAnnot _DTW( const Index& ptIndex, const std::map<Index,_DTWAnnot>& dtwAnnots ) const;
 
 	Skeleton* mSkel;
@@ -146,10 +146,17 @@ public:
 	* Shorter chains are discarded (default value is 0.25s).
 	* @param maxBridgeLength Maximum length of a bridge between a pair
 	* of minima chains (default value is 2s).
+	* @param numThreads Number of threads building match webs in parallel,
+	* including the calling thread.
+	* @remark Match webs are built in batches. Once a batch is finished,
+	* its match webs are added to the index and MatchWebBuiltEvents are
+	* emitted on the calling thread, in the same order as in a single-threaded
+	* build. While the index is being built, the skeleton must not be modified.
 	*/
 	void buildIndex( unsigned int resampleFactor = 3,
 		float wndLength = 0.35f, float minDist = 0.05f,
-		float maxDistDiff = 0.15f, float minChainLength = 0.25f, float maxBridgeLength = 1.f );
+		float maxDistDiff = 0.15f, float minChainLength = 0.25f, float maxBridgeLength = 1.f,
+		unsigned int numThreads = 1 );
 
 	/**
 	* Deletes the current animation index.
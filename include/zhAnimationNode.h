@@ -28,6 +28,7 @@ SOFTWARE.
 #include "zhObjectFactory.h"
 #include "zhSkeleton.h"
 #include "zhAnimation.h"
+#include "zhPose.h"
 #include "zhAnimationNodeEvents.h"
 #include "zhAnimationAdaptor.h"
 
@@ -60,11 +61,12 @@ class zhDeclSpec AnimationNode : public TransitionAnnotEmitter,
 {
 
 	friend class AnimationTree;
+	friend class AnimationProgram;
 
 public:
 
-	typedef MapIterator< std::map<unsigned short, AnimationNode*> > ChildIterator;
-	typedef MapConstIterator< std::map<unsigned short, AnimationNode*> > ChildConstIterator;
+	typedef VectorIterator< std::vector<AnimationNode*> > ChildIterator;
+	typedef VectorConstIterator< std::vector<AnimationNode*> > ChildConstIterator;
 
 	zhDeclare_BaseClass( AnimationNode, 0, "AnimationNode", unsigned short )
 
@@ -401,7 +403,7 @@ public:
 	/**
 	* Gets the bone mask used on this animation node.
 	*/
-	virtual const std::set<unsigned short>& getBoneMask() const;
+	virtual const BoneMask& getBoneMask() const;
 
 	/**
 	* Updates this animation node with elapsed time.
@@ -416,7 +418,15 @@ public:
 	* @param weight Blend weight.
 	* @param boneMask Bone mask. Animation is not applied to masked bones.
 	*/
-	virtual void apply( float weight = 1.f, const std::set<unsigned short>& boneMask = Animation::EmptyBoneMask ) const;
+	virtual void apply( float weight = 1.f, const BoneMask& boneMask = Animation::EmptyBoneMask ) const;
+
+	/**
+	* Applies this animation node to the current model.
+	*
+	* @remark This is a convenience overload which converts the bone mask
+	* into a BoneMask on each call. Prefer the BoneMask overload in per-frame code.
+	*/
+	void apply( float weight, const std::set<unsigned short>& boneMask ) const;
 
 	/**
 	* Get the previous play time of this animation node.
@@ -474,7 +484,7 @@ protected:
 	* @param weight Blend weight.
 	* @param boneMask Bone mask. Animation is not applied to masked bones.
 	*/
-	virtual void _applyNode( float weight = 1.f, const std::set<unsigned short>& boneMask = Animation::EmptyBoneMask ) const;
+	virtual void _applyNode( float weight = 1.f, const BoneMask& boneMask = Animation::EmptyBoneMask ) const;
 
 	/**
 	* Determines which annotations are active, which are no longer active,
@@ -484,9 +494,32 @@ protected:
 	*/
 	virtual void _applyAnnotations() const;
 
+	/**
+	* Starts blending child nodes into the pose accumulator of this node.
+	* Leaf nodes applied afterwards accumulate their poses
+	* instead of modifying the skeleton.
+	*
+	* @return true if blending has started, false if an ancestor
+	* node is already blending, in which case child poses are
+	* accumulated into the ancestor's accumulator.
+	*/
+	bool _beginPoseBlend() const;
+
+	/**
+	* Applies the poses accumulated since _beginPoseBlend()
+	* to the current skeleton. Only call this if _beginPoseBlend() returned true.
+	*/
+	void _endPoseBlend() const;
+
+	/**
+	* Removes the specified node from the list of child nodes.
+	*/
+	virtual void _eraseChild( AnimationNode* node );
+
 	std::string mName; ///< init'ed by AnimationTree::createNode()
 	AnimationTree* mOwner; ///< init'ed by AnimationTree::createNode()
 	AnimationNode* mParent;
+	std::vector<AnimationNode*> mChildren; ///< Child nodes, ordered by ID unless a subclass reorders them.
 	std::map<unsigned short, AnimationNode*> mChildrenById;
 	std::map<std::string, AnimationNode*> mChildrenByName;
 	mutable AnimationNode* mMainChild;
@@ -502,8 +535,15 @@ protected:
 	ParamTransitionAnnotationContainer* mParamTransAnnots;
 	PlantConstraintAnnotationContainer* mPlantConstrAnnots;
 	SimEventAnnotationContainer* mSimEventAnnots;
-
-	std::set<unsigned short> mBoneMask;
+	mutable std::vector<AnimationAnnotation*> mAnnotBuffer; ///< Reusable storage for annotation query results.
+	mutable AnnotationCursor mTransAnnotCursor;
+	mutable AnnotationCursor mParamTransAnnotCursor;
+	mutable AnnotationCursor mPlantConstrAnnotCursor;
+	mutable AnnotationCursor mSimEventAnnotCursor;
+
+	BoneMask mBoneMask;
+	mutable BoneMask mMergedBoneMask; ///< Storage for the bone mask merged with the parent's mask in apply().
+	mutable PoseAccumulator mPoseAccum; ///< Accumulator for blending child poses.
 
 	float mDt;
 
@@ -0,0 +1,183 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhAnimationProgram_h__
+#define __zhAnimationProgram_h__
+
+#include "zhPrereq.h"
+#include "zhBoneMask.h"
+#include "zhPose.h"
+
+namespace zh
+{
+
+class AnimationTree;
+class AnimationNode;
+class AnimationQueueNode;
+
+/**
+* @brief Animation tree compiled into a flat list of instructions.
+*
+* Instead of recursing through AnimationNode::apply(), the program
+* visits the nodes of the tree in the same order using a linear
+* list of instructions. Each node is entered with a blend weight computed
+* from its parent's weight, which is kept on a weight stack. Leaf nodes
+* accumulate their poses into a single pose accumulator, which is
+* applied to the skeleton when the program finishes, so the result
+* is the same as evaluating the tree recursively.
+*
+* The program only needs to be recompiled when the structure of the tree
+* changes (nodes, children, bone masks, adaptors), or when a queue node
+* enters or leaves a transition. Trees with animation adaptors
+* or queue nodes transitioning into their current node are not supported
+* and should be evaluated recursively instead.
+*/
+class zhDeclSpec AnimationProgram
+{
+
+public:
+
+	/**
+	* Instruction opcodes.
+	*/
+	enum Opcode
+	{
+		Opcode_Enter, ///< Push node weight, or jump past node if it contributes nothing.
+		Opcode_Sample, ///< Apply leaf node with the current weight.
+		Opcode_EmitTransitionEvents, ///< Notify listeners of queue node transition.
+		Opcode_Exit ///< Emit node annotations and pop node weight.
+	};
+
+	/**
+	* Sources of node weights relative to the parent's weight.
+	*/
+	enum WeightSource
+	{
+		WeightSource_Parent, ///< Parent weight.
+		WeightSource_BlendChild, ///< Parent weight times blend weight.
+		WeightSource_QueueCurrent, ///< Parent weight times weight of the current queued node.
+		WeightSource_QueueNext ///< Parent weight times weight of the next queued node.
+	};
+
+	/**
+	* Program instruction.
+	*/
+	struct Instruction
+	{
+		Opcode opcode;
+		const AnimationNode* node;
+		const AnimationNode* weightNode; ///< Node providing the weight (Opcode_Enter).
+		WeightSource weightSource;
+		unsigned int arg; ///< Blend weight index (Opcode_Enter) or bone mask index (Opcode_Sample).
+		unsigned int jump; ///< Index of the instruction after the node's Opcode_Exit (Opcode_Enter).
+	};
+
+	/**
+	* Constructor.
+	*/
+	AnimationProgram();
+
+	/**
+	* Destructor.
+	*/
+	~AnimationProgram();
+
+	/**
+	* Compiles the specified animation tree into the program.
+	*
+	* @param tree Pointer to the animation tree.
+	* @return true if the tree can be evaluated by the program,
+	* false otherwise.
+	*/
+	bool compile( const AnimationTree* tree );
+
+	/**
+	* Marks the program as needing recompilation.
+	*/
+	void invalidate();
+
+	/**
+	* Returns true if the program is still up to date with the tree
+	* it was compiled from, false otherwise.
+	*/
+	bool isValid() const;
+
+	/**
+	* Returns true if the last compiled tree can be evaluated
+	* by the program, false otherwise.
+	*/
+	bool isSupported() const;
+
+	/**
+	* Gets the number of instructions in the program.
+	*/
+	unsigned int getNumInstructions() const;
+
+	/**
+	* Gets the instruction at the specified index.
+	*/
+	const Instruction& getInstruction( unsigned int index ) const;
+
+	/**
+	* Runs the program, applying animation to the current skeleton
+	* of the animation tree.
+	*
+	* @param tree Pointer to the animation tree the program was compiled from.
+	* @param boneMask Bones which should not be animated.
+	*/
+	void run( AnimationTree* tree, const BoneMask& boneMask );
+
+private:
+
+	/**
+	* Queue node state the program was compiled for.
+	*/
+	struct QueueGuard
+	{
+		const AnimationQueueNode* node;
+		const AnimationNode* currentNode;
+		const AnimationNode* nextNode;
+	};
+
+	bool _getEnterWeight( const Instruction& instr, float parentWeight, float& weight ) const; ///< Gets node weight, returns false if the node is inactive.
+	bool _needsPoseBlend(); ///< Checks if leaf poses need to be blended in the pose accumulator.
+	bool _compileNode( const AnimationNode* node, const AnimationNode* weightNode,
+		WeightSource weightSrc, unsigned int weightIndex, const BoneMask& boneMask, unsigned int depth );
+	void _emit( Opcode opcode, const AnimationNode* node, const AnimationNode* weightNode = NULL,
+		WeightSource weightSrc = WeightSource_Parent, unsigned int arg = 0 );
+
+	bool mCompiled;
+	bool mSupported;
+	std::vector<Instruction> mInstructions;
+	std::vector<BoneMask> mBoneMasks; ///< Merged bone masks of leaf nodes.
+	std::vector<QueueGuard> mQueueGuards;
+	unsigned int mMaxDepth;
+
+	std::vector<float> mWeightStack;
+	BoneMask mMergedBoneMask;
+	PoseAccumulator mPoseAccum;
+
+};
+
+}
+
+#endif // __zhAnimationProgram_h__
@@ -319,6 +319,12 @@ public:
 	*/
 	virtual bool _getTransitionFinished() const;
 
+	/**
+	* Notifies listeners that a transition has started or finished
+	* since the last call.
+	*/
+	void _emitTransitionEvents() const;
+
 	/**
 	* Samples this animation's mover at the current time.
 	*
@@ -357,7 +363,7 @@ protected:
 	* @param weight Blend weight.
 	* @param boneMask Bone mask. Animation is not applied to masked bones.
 	*/
-	void _applyNode( float weight = 1.f, const std::set<unsigned short>& boneMask = Animation::EmptyBoneMask ) const;
+	void _applyNode( float weight = 1.f, const BoneMask& boneMask = Animation::EmptyBoneMask ) const;
 
 	AnimationNode* mCurrentNode;
 	AnimationNode* mNextNode;
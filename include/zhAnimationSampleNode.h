@@ -30,6 +30,7 @@ SOFTWARE.
 #include "zhAnimationNode.h"
 #include "zhAnimationManager.h"
 #include "zhAnimation.h"
+#include "zhPose.h"
 #include "zhAnimationAnnotation.h"
 
 namespace zh
@@ -162,6 +163,8 @@ public:
 	* @remark This is a helper method used for alignment of consecutive animations.
 	* Any node that represents an animation with a mover channel
 	* should override this method, otherwise alignment won't work correctly.
+	* The mover is sampled from the precomputed mover curve when one is available
+	* (see Animation::getMoverCurve()), which approximates sampling the root track.
 	*/
 	Skeleton::Situation _sampleMover() const;
 
@@ -193,10 +196,15 @@ protected:
 	* @param weight Blend weight.
 	* @param boneMask Bone mask. Animation is not applied to masked bones.
 	*/
-	void _applyNode( float weight = 1.f, const std::set<unsigned short>& boneMask = Animation::EmptyBoneMask ) const;
+	void _applyNode( float weight = 1.f, const BoneMask& boneMask = Animation::EmptyBoneMask ) const;
 
 	float mPlayTime;
 	Skeleton::Situation mOrigin;
+	float mOriginOrientY; ///< Origin heading.
+	bool mOriginOnGround; ///< If true, origin orientation is a pure heading rotation.
+	mutable KeyFrameCursor mKFCursor; ///< Playback cursor for key-frame lookup.
+	mutable Pose mPose; ///< Pose buffer into which the animation is sampled.
+	mutable BoneMask mMoverBoneMask; ///< Bone mask with the root bone masked out for mover application.
 
 	AnimationSetPtr mAnimSet;
 	unsigned short mAnimId;
@@ -29,6 +29,10 @@ SOFTWARE.
 #include "zhSingleton.h"
 #include "zhSkeleton.h"
 #include "zhAnimationTree.h"
+#include "zhCharacter.h"
+#include "zhThreadPool.h"
+#include "zhEventQueue.h"
+#include "zhScratchArena.h"
 
 #define zhAnimationSystem zh::AnimationSystem::Instance()
 #define zhA(animSetName, animName) ((animSetName)+"::"+(animName))
@@ -63,6 +67,8 @@ public:
 	
 	typedef MapIterator< std::map<std::string, Skeleton*> > SkeletonIterator;
 	typedef MapConstIterator< std::map<std::string, Skeleton*> > SkeletonConstIterator;
+	typedef VectorIterator< std::vector<Character*> > CharacterIterator;
+	typedef VectorConstIterator< std::vector<Character*> > CharacterConstIterator;
 
 	typedef ObjectFactory<AnimationNode, unsigned short> AnimationNodeFactory;
 	typedef ObjectFactory<IKSolver, unsigned short> IKSolverFactory;
@@ -339,6 +345,9 @@ public:
 
 	/**
 	* Updates and applies the currently playing animation.
+	*
+	* @remark If event deferral is enabled, events emitted
+	* during the update are delivered after the update is complete.
 	*/
 	void update( float dt ) const;
 
@@ -347,6 +356,114 @@ public:
 	*/
 	AnimationTree* getAnimationTree() const;
 
+	/**
+	* Creates a new character instance.
+	*
+	* @param name Character name.
+	* @param skelName Name of the skeleton which is copied to create
+	* the character skeleton.
+	* @param animTree Animation tree which is copied to create
+	* the character animation tree. If NULL, the main animation tree is copied.
+	* @return Pointer to the character.
+	* @remark Characters share animation data with the copied tree, so
+	* creating many of them is cheap. Animation adaptors (retargetting) are
+	* not copied. New characters use the default level-of-detail policy
+	* (see getLODPolicy()).
+	*/
+	Character* createCharacter( const std::string& name, const std::string& skelName,
+		const AnimationTree* animTree = NULL );
+
+	/**
+	* Deletes the character with the specified name.
+	*/
+	void deleteCharacter( const std::string& name );
+
+	/**
+	* Deletes all characters.
+	*/
+	void deleteAllCharacters();
+
+	/**
+	* Returns true if the character with the specified name exists,
+	* false otherwise.
+	*/
+	bool hasCharacter( const std::string& name ) const;
+
+	/**
+	* Gets the character with the specified name.
+	*/
+	Character* getCharacter( const std::string& name ) const;
+
+	/**
+	* Gets an iterator over the list of characters.
+	*/
+	CharacterIterator getCharacterIterator();
+
+	/**
+	* Gets a const iterator over the list of characters.
+	*/
+	CharacterConstIterator getCharacterConstIterator() const;
+
+	/**
+	* Gets the number of characters.
+	*/
+	unsigned int getNumCharacters() const;
+
+	/**
+	* Updates and applies the currently playing animation,
+	* then updates all character instances.
+	*
+	* @param dt Elapsed time.
+	* @remark Characters are updated in parallel on worker threads.
+	* Each character update touches only that character's data, so
+	* the results don't depend on the number of threads. If more than
+	* one thread is used, events are always deferred and delivered
+	* on the calling thread after all characters have been updated.
+	*/
+	void updateAll( float dt );
+
+	/**
+	* Returns true if events emitted during updates are deferred
+	* and delivered in one batch at the end of the update,
+	* false if they are delivered immediately.
+	*/
+	bool getEventsDeferred() const;
+
+	/**
+	* Specifies if events emitted during updates are deferred
+	* and delivered in one batch at the end of the update.
+	*/
+	void setEventsDeferred( bool deferred = true );
+
+	/**
+	* Gets the number of threads used to update characters,
+	* including the calling thread.
+	*/
+	unsigned int getNumWorkerThreads() const;
+
+	/**
+	* Sets the number of threads used to update characters,
+	* including the calling thread.
+	*
+	* @remark Has no effect unless multi-threading is enabled
+	* (see zhMultiThreading_Enabled).
+	*/
+	void setNumWorkerThreads( unsigned int numThreads );
+
+	/**
+	* Gets the default level-of-detail policy for characters.
+	*
+	* @remark The policy has no levels by default, i.e. characters are
+	* animated at full detail. The policy must not be modified
+	* while characters are being updated.
+	*/
+	LODPolicy& getLODPolicy();
+
+	/**
+	* Gets the default level-of-detail policy for characters.
+	*/
+	const LODPolicy& getLODPolicy() const;
+
 	// TODO: add functions for end-effector specification and cleanup
 
 	/**
@@ -364,6 +481,11 @@ public:
 	*/
 	MemoryPool* _getMemoryPool() const;
 
+	/**
+	* Gets the queue into which events are deferred during updates.
+	*/
+	EventQueue& _getEventQueue() const;
+
 	/**
 	* Parses the fully-qualified animation name to obtain animation set name
 	* and animation clip name.
@@ -377,6 +499,14 @@ private:
 	Skeleton* mOutSkel;
 	AnimationTree* mAnimTree;
 
+	std::vector<Character*> mCharacters; ///< Characters, kept contiguous for batch updates.
+	std::map<std::string, Character*> mCharactersByName;
+	ThreadPool mThreadPool;
+	LODPolicy mLODPolicy;
+	bool mEventsDeferred;
+	mutable EventQueue mEventQueue;
+	mutable ScratchArena mScratchArena; ///< Arena for temporaries allocated during update().
+
 	AnimationNodeFactory mAnimNodeFact;
 	IKSolverFactory mIKSolverFact;
 };
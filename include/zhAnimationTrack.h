@@ -96,6 +96,23 @@ public:
 
 };
 
+/**
+* @brief Playback cursor, which remembers the key-frame index
+* found by the last lookup on an animation track. When playback time
+* is (mostly) monotonic, the next lookup can step forward
+* from the cursor instead of searching the track.
+*/
+struct KeyFrameCursor
+{
+
+public:
+
+	KeyFrameCursor() : mKeyFrameIndex(0) { }
+
+	unsigned int mKeyFrameIndex; ///< Index of the left-hand key-frame found by the last lookup.
+
+};
+
 /**
 * @brief Base class for animation tracks.
 */
@@ -158,6 +175,10 @@ public:
 	* 
 	* @param index Key-frame index.
 	* @return Pointer to the key-frame.
+	* @remark Key-frame objects are created for the whole track the first time
+	* they are accessed (here, in createKeyFrame() or through key-frame iterators),
+	* which is not thread-safe. Loaders and samplers use per-index accessors
+	* of concrete tracks instead, so most tracks never create them.
 	*/
 	virtual KeyFrame* getKeyFrame( unsigned int index ) const;
 
@@ -166,6 +187,16 @@ public:
 	*/
 	virtual unsigned int getNumKeyFrames() const;
 
+	/**
+	* Gets the time of the key-frame at the specified index.
+	*
+	* @param index Key-frame index.
+	* @return Key-frame time.
+	* @remark Key-frame times are stored in a single packed array,
+	* so this is cheaper than getKeyFrame(index)->getTime().
+	*/
+	float getKeyFrameTime( unsigned int index ) const;
+
 	/**
 	* Gets an iterator over the vector of key-frames.
 	*/
@@ -187,6 +218,29 @@ public:
 	*/
 	virtual float getKeyFramesAtTime( float time, KeyFrame** kf1, KeyFrame** kf2 ) const;
 
+	/**
+	* Gets the indexes of the two key-frames adjacent to the specified time.
+	*
+	* @param time Track sampling time.
+	* @param kfi1 Index of the first key-frame.
+	* @param kfi2 Index of the second key-frame.
+	* @param cursor Playback cursor to start the lookup from
+	* (updated with the result) or NULL.
+	* @return Parameter t which indicates where the sampling time
+	* point lies between the two key-frames (normalized 0-1 range is used).
+	* @remark Track must contain at least one key-frame. If key-frames
+	* are uniformly spaced, key-frame indexes are computed directly
+	* from the time, otherwise they are found by binary search.
+	*/
+	virtual float getKeyFrameIndicesAtTime( float time, unsigned int& kfi1, unsigned int& kfi2,
+		KeyFrameCursor* cursor = NULL ) const;
+
+	/**
+	* Returns true if key-frames on this track are uniformly spaced in time
+	* (e.g. sampled at the animation frame rate), otherwise false.
+	*/
+	bool hasUniformKeyFrameSpacing() const;
+
 	/**
 	* Gets the key-frame interpolated from the neighboring key-frames
 	* at the specified time.
@@ -213,17 +267,30 @@ public:
 	* @param weight Blend weight with which this animation track
 	* should be applied.
 	* @param scale Scaling factor applied to this animation track.
+	* @param cursor Playback cursor used for key-frame lookup or NULL.
 	*/
-	virtual void apply( Skeleton* skeleton, float time, float weight = 1.f, float scale = 1.f ) const = 0;
+	virtual void apply( Skeleton* skeleton, float time, float weight = 1.f, float scale = 1.f,
+		KeyFrameCursor* cursor = NULL ) const = 0;
 
 protected:
 
 	virtual KeyFrame* _createKeyFrame( float time ) = 0; ///< Actual key-frame creation, implemented in concrete AnimationTrack subclasses.
+	virtual void _insertKeyFrameData( unsigned int index ) { } ///< Inserts key-frame data into packed arrays of concrete AnimationTrack subclasses.
+	virtual void _deleteKeyFrameData( unsigned int index ) { } ///< Deletes key-frame data from packed arrays of concrete AnimationTrack subclasses.
+	virtual void _deleteAllKeyFrameData() { } ///< Clears packed arrays of concrete AnimationTrack subclasses.
+	unsigned int _insertKeyFrame( float time ); ///< Inserts key-frame time (if not present) and returns key-frame index.
+	void _destroyKeyFrames();
+	void _createKeyFrameViews() const; ///< Creates key-frame objects for all key-frames, if they don't exist yet.
 	virtual void _updateKeyFrameIndices();
+	void _updateKeyFrameSpacing(); ///< Checks if key-frames are uniformly spaced and updates the spacing.
+	unsigned int _findKeyFrameIndex( float time ) const; ///< Finds index of the last key-frame at or before the specified time.
 
 	Animation* mAnim;
 
-	std::vector<KeyFrame*> mKeyFrames;
+	std::vector<float> mKeyTimes; ///< Key-frame times, packed.
+	mutable std::vector<KeyFrame*> mKeyFrames; ///< Key-frame objects for the KeyFrame API, created on first access (empty until then).
+	float mKeySpacing; ///< Time between key-frames, if they are uniformly spaced, otherwise 0.
+	float mInvKeySpacing; ///< Inverse of mKeySpacing.
 
 };
 
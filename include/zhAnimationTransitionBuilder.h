@@ -32,6 +32,7 @@ class Skeleton;
 class Animation;
 class AnimationSpace;
 class MatchGraph;
+class ThreadPool;
 
 /**
 * @brief Class that provides implementations of algorithms
@@ -61,6 +62,19 @@ public:
 	*/
 	virtual Skeleton* getSkeleton() const { return mSkel; }
 
+	/**
+	* Gets the number of threads building each animation distance grid.
+	*/
+	virtual unsigned int getNumThreads() const;
+
+	/**
+	* Sets the number of threads building each animation distance grid,
+	* including the calling thread (default value is 1, i.e. no parallelism).
+	*
+	* @remark The threads are kept running between grid builds.
+	*/
+	virtual void setNumThreads( unsigned int numThreads = 1 );
+
 	/**
 	* Builds a transition between two animations.
 	*
@@ -114,6 +128,7 @@ public:
 protected:
 
 	Skeleton* mSkel;
+	ThreadPool* mThreadPool;
 
 };
 
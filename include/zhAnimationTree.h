@@ -33,6 +33,7 @@ SOFTWARE.
 #include "zhAnimationBlendNode.h"
 #include "zhAnimationQueueNode.h"
 #include "zhAnimationAdaptor.h"
+#include "zhAnimationProgram.h"
 
 namespace zh
 {
@@ -183,6 +184,32 @@ public:
 	*/
 	virtual void setApplyMover( bool applyMover = true );
 
+	/**
+	* Returns true if animation nodes in this tree emit
+	* annotation events, false otherwise.
+	*/
+	virtual bool getAnnotationsEnabled() const;
+
+	/**
+	* If set to false, no animation node in this tree emits
+	* annotation events, regardless of its own setting.
+	*/
+	virtual void setAnnotationsEnabled( bool enabled = true );
+
+	/**
+	* Returns true if the tree is compiled into an AnimationProgram
+	* for evaluation, false if it is evaluated recursively.
+	*/
+	virtual bool getProgramEnabled() const;
+
+	/**
+	* If set to true, the tree is compiled into an AnimationProgram,
+	* which is then used to apply animation. The program is recompiled
+	* automatically when the tree structure changes. Trees the program
+	* doesn't support are still evaluated recursively.
+	*/
+	virtual void setProgramEnabled( bool enabled = true );
+
 	/**
 	* Updates the animation tree instance with elapsed time.
 	*
@@ -194,8 +221,10 @@ public:
 	* Applies animation in this instance to the specified character skeleton.
 	*
 	* @param skel Pointer to the Skeleton that animation should be applied to.
+	* @param boneMask Bones which should not be animated. These bones
+	* are left in their initial pose.
 	*/
-	virtual void apply( Skeleton* skel ) const;
+	virtual void apply( Skeleton* skel, const BoneMask& boneMask = Animation::EmptyBoneMask ) const;
 
 	/**
 	* Creates a deep copy of the animation tree.
@@ -237,6 +266,22 @@ public:
 	*/
 	virtual void _setCurrentSkeleton( Skeleton* skel );
 
+	/**
+	* Gets a pointer to the pose accumulator into which animation
+	* is being blended, or NULL if animation is applied directly to
+	* the current skeleton.
+	*
+	* @remark Blend nodes set the accumulator while their children are
+	* applied, see AnimationBlendNode::_applyNode().
+	*/
+	virtual PoseAccumulator* _getCurrentPoseAccumulator() const;
+
+	/**
+	* Sets pointer to the pose accumulator into which animation
+	* is being blended.
+	*/
+	virtual void _setCurrentPoseAccumulator( PoseAccumulator* poseAccum );
+
 	/**
 	* Gets the character situation at the end of previous frame.
 	*/
@@ -247,6 +292,17 @@ public:
 	*/
 	virtual void _setPrevSituation( const Skeleton::Situation& sit );
 
+	/**
+	* Gets the program the tree is compiled into.
+	*/
+	virtual const AnimationProgram& _getProgram() const;
+
+	/**
+	* Marks the compiled program as out of date. Called
+	* when the tree structure changes.
+	*/
+	virtual void _invalidateProgram();
+
 protected:
 
 	std::string mName;
@@ -254,9 +310,13 @@ protected:
 	std::map<unsigned short, AnimationNode*> mNodesById;
 	std::map<std::string, AnimationNode*> mNodesByName;
 	bool mApplyMover;
+	bool mAnnotsEnabled;
 	float mTotalWeight;
 	mutable Skeleton* mCurSkel;
+	mutable PoseAccumulator* mCurPoseAccum;
 	mutable Skeleton::Situation mPrevSit;
+	bool mProgramEnabled;
+	mutable AnimationProgram mProgram;
 };
 
 }
@@ -70,6 +70,8 @@ enum BoneTag
 class zhDeclSpec Bone
 {
 
+	friend class Skeleton;
+
 public:
 
 	typedef MapIterator< std::map<unsigned short, Bone*> > ChildIterator;
@@ -100,7 +102,11 @@ public:
 	*/
 	const std::string& getName() const { return mName; }
 
-	// TODO: cache world transf.
+	/**
+	* Gets the index of the bone in the skeleton's
+	* compiled topology (see Skeleton::getBoneByIndex).
+	*/
+	unsigned int getIndex() const;
 
 	/**
 	* Gets the bone's local position.
@@ -114,6 +120,12 @@ public:
 
 	/**
 	* Gets the bone's world position.
+	*
+	* @remark World transformations are cached and recomputed
+	* only after the bone or one of its ancestors has moved.
+	* Calling this on the same skeleton from multiple threads
+	* is not safe, unless Skeleton::updateWorldTransforms
+	* has been called beforehand.
 	*/
 	Vector3 getWorldPosition() const;
 
@@ -331,11 +343,30 @@ public:
 	*/
 	void untag();
 
+	/**
+	* Returns true if the bone's cached world transformation
+	* is out of date, otherwise false.
+	*/
+	bool _isWorldTransformDirty() const { return mWorldDirty; }
+
+	/**
+	* Marks the cached world transformations of this bone
+	* and its descendants as out of date.
+	*/
+	void _invalidateWorldTransform();
+
+	/**
+	* Recomputes the cached world transformation of this bone
+	* (and its ancestors, if they are out of date).
+	*/
+	void _updateWorldTransform() const;
+
 private:
 
 	unsigned short mId;
 	std::string mName;
 	Skeleton* mSkel;
+	unsigned int mIndex;
 	Bone* mParent;
 	std::map<unsigned short, Bone*> mChildrenById;
 	std::map<std::string, Bone*> mChildrenByName;
@@ -347,6 +378,12 @@ private:
 	Quat mOrient;
 	Vector3 mScal;
 
+	// cached world transformation
+	mutable Vector3 mWorldPos;
+	mutable Quat mWorldOrient;
+	mutable Vector3 mWorldScal;
+	mutable bool mWorldDirty;
+
 };
 
 }
@@ -31,17 +31,26 @@ SOFTWARE.
 namespace zh
 {
 
+class BoneAnimationTrack;
+
 /**
 * @brief Class representing a transform (translation, rotation, scale)
 * key-frame.
+*
+* Key-frames created by a BoneAnimationTrack are views into the
+* track's packed key-frame arrays, so they store no transformation of their own.
+* Key-frames constructed directly are detached and keep their transformation
+* in separately allocated storage.
 */
 class zhDeclSpec TransformKeyFrame : public KeyFrame
 {
 
+	friend class BoneAnimationTrack;
+
 public:
 
 	/**
-	* Constructor.
+	* Constructor. Creates a detached key-frame.
 	*/
 	TransformKeyFrame( float time, unsigned int index );
 
@@ -82,9 +91,20 @@ public:
 
 private:
 
-	Vector3 mTranslation;
-	Quat mRotation;
-	Vector3 mScale;
+	TransformKeyFrame( float time, unsigned int index, BoneAnimationTrack* track );
+
+	/**
+	* Transformation of a detached key-frame.
+	*/
+	struct Transform
+	{
+		Vector3 mTranslation;
+		Quat mRotation;
+		Vector3 mScale;
+	};
+
+	BoneAnimationTrack* mTrack; ///< Owning track, or NULL if the key-frame is detached.
+	Transform* mTransf; ///< Transformation of a detached key-frame, otherwise NULL.
 
 };
 
@@ -133,6 +153,63 @@ public:
 	*/
 	void getInterpolatedKeyFrame( float time, KeyFrame* kf ) const;
 
+	/**
+	* Gets the transformation interpolated from the neighboring key-frames
+	* at the specified time.
+	*
+	* @param time Track sampling time.
+	* @param trans Interpolated translation.
+	* @param rot Interpolated rotation.
+	* @param scal Interpolated scale.
+	* @param cursor Playback cursor used for key-frame lookup or NULL.
+	*/
+	void getInterpolatedTransform( float time, Vector3& trans, Quat& rot, Vector3& scal,
+		KeyFrameCursor* cursor = NULL ) const;
+
+	/**
+	* Creates a new key-frame and sets its transformation.
+	* Unlike createKeyFrame, this doesn't require
+	* going through the KeyFrame interface.
+	*
+	* @param time Key-frame time.
+	* @param trans Translation.
+	* @param rot Rotation.
+	* @param scal Scale.
+	* @return Key-frame index.
+	*/
+	unsigned int createTransformKeyFrame( float time, const Vector3& trans,
+		const Quat& rot, const Vector3& scal = Vector3(1,1,1) );
+
+	/**
+	* Gets the translation component of the key-frame at the specified index.
+	*/
+	const Vector3& getKeyFrameTranslation( unsigned int index ) const;
+
+	/**
+	* Sets the translation component of the key-frame at the specified index.
+	*/
+	void setKeyFrameTranslation( unsigned int index, const Vector3& trans );
+
+	/**
+	* Gets the rotation component of the key-frame at the specified index.
+	*/
+	const Quat& getKeyFrameRotation( unsigned int index ) const;
+
+	/**
+	* Sets the rotation component of the key-frame at the specified index.
+	*/
+	void setKeyFrameRotation( unsigned int index, const Quat& rot );
+
+	/**
+	* Gets the scale component of the key-frame at the specified index.
+	*/
+	const Vector3& getKeyFrameScale( unsigned int index ) const;
+
+	/**
+	* Sets the scale component of the key-frame at the specified index.
+	*/
+	void setKeyFrameScale( unsigned int index, const Vector3& scal );
+
 	/**
 	* Applies the animation track to the specified skeleton.
 	*
@@ -142,28 +219,57 @@ public:
 	* @param weight Blend weight with which this animation track
 	* should be applied.
 	* @param scale Scaling factor applied to this animation track.
+	* @param cursor Playback cursor used for key-frame lookup or NULL.
 	*/
-	 void apply( Skeleton* skel, float time, float weight = 1.f, float scale = 1.f ) const;
+	 void apply( Skeleton* skel, float time, float weight = 1.f, float scale = 1.f,
+		 KeyFrameCursor* cursor = NULL ) const;
 
 	 /**
 	 * Builds the splines used for key-frame interpolation.
 	 *
-	 * @remark This function is called automatically by Animation.
+	 * @remark This function is called by Animation::buildInterpSplines().
 	 * Do not call it manually without a good reason.
 	 */
-	 void _buildInterpSplines() const;
+	 void _buildInterpSplines();
+
+	 /**
+	 * Returns true if the splines used for key-frame interpolation
+	 * are built and up to date with the key-frames, otherwise false.
+	 */
+	 bool _hasInterpSplines() const;
+
+	 /**
+	 * Gets the key-frame version number, which changes
+	 * whenever key-frames are edited.
+	 */
+	 unsigned int _getKeyFrameVersion() const;
 
 protected:
 
 	KeyFrame* _createKeyFrame( float time );
+	void _insertKeyFrameData( unsigned int index );
+	void _deleteKeyFrameData( unsigned int index );
+	void _deleteAllKeyFrameData();
+
+	/**
+	* Discards the interpolation splines after key-frames have been edited.
+	*/
+	void _clearInterpSplines();
 
 private:
 
 	unsigned short mBoneId;
+	unsigned int mKFVersion;
+
+	// key-frame transformations, packed and indexed by key-frame index
+	std::vector<Vector3> mTranslations;
+	std::vector<Quat> mRotations;
+	std::vector<Vector3> mScales;
 
-	mutable CatmullRomSpline<Vector3> mTransSpline;
-	mutable CatmullRomSpline<Quat> mRotSpline;
-	mutable CatmullRomSpline<Vector3> mScalSpline;
+	// interpolation splines, built eagerly so sampling never modifies the track
+	CatmullRomSpline<Vector3> mTransSpline;
+	CatmullRomSpline<Quat> mRotSpline;
+	CatmullRomSpline<Vector3> mScalSpline;
 
 };
 
@@ -0,0 +1,136 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhBoneMask_h__
+#define __zhBoneMask_h__
+
+#include "zhPrereq.h"
+
+namespace zh
+{
+
+/**
+* @brief Class representing a set of masked bones, stored as a bitset
+* indexed by bone ID.
+*
+* Testing a bone and merging two masks are cheap word operations,
+* and storage is only allocated when the mask grows, so masks can be
+* combined every frame without touching the heap.
+*/
+class zhDeclSpec BoneMask
+{
+
+public:
+
+	/**
+	* Constructor.
+	*/
+	BoneMask();
+
+	/**
+	* Constructor.
+	*
+	* @param capacity Number of bone IDs the mask can hold
+	* without reallocating (typically the number of bones in the skeleton).
+	*/
+	explicit BoneMask( unsigned int capacity );
+
+	/**
+	* Constructor. Creates a mask from a set of bone IDs.
+	*/
+	explicit BoneMask( const std::set<unsigned short>& boneIds );
+
+	/**
+	* Gets the number of bone IDs the mask can hold without reallocating.
+	*/
+	unsigned int getCapacity() const;
+
+	/**
+	* Grows the mask so it can hold bone IDs up to the specified capacity.
+	*/
+	void reserve( unsigned int capacity );
+
+	/**
+	* Masks the specified bone.
+	*/
+	void insert( unsigned short boneId );
+
+	/**
+	* Unmasks the specified bone.
+	*/
+	void erase( unsigned short boneId );
+
+	/**
+	* Unmasks all bones. Storage is kept.
+	*/
+	void clear();
+
+	/**
+	* Returns true if the specified bone is masked, otherwise false.
+	*/
+	bool isMasked( unsigned short boneId ) const;
+
+	/**
+	* Returns true if no bones are masked, otherwise false.
+	*/
+	bool empty() const;
+
+	/**
+	* Sets this mask to a copy of the specified mask.
+	* Storage is reused if large enough.
+	*/
+	void assign( const BoneMask& mask );
+
+	/**
+	* Merges the specified mask into this mask.
+	*/
+	void unite( const BoneMask& mask );
+
+	/**
+	* Gets the IDs of all masked bones.
+	*/
+	void getBoneIds( std::set<unsigned short>& boneIds ) const;
+
+private:
+
+	std::vector<unsigned int> mBits;
+
+};
+
+inline bool BoneMask::isMasked( unsigned short boneId ) const
+{
+	unsigned int wi = boneId >> 5;
+	return wi < mBits.size() && ( mBits[wi] & ( 1u << ( boneId & 31 ) ) ) != 0;
+}
+
+inline void BoneMask::unite( const BoneMask& mask )
+{
+	if( mask.mBits.size() > mBits.size() )
+		mBits.resize( mask.mBits.size(), 0 );
+
+	for( unsigned int wi = 0; wi < mask.mBits.size(); ++wi )
+		mBits[wi] |= mask.mBits[wi];
+}
+
+}
+
+#endif // __zhBoneMask_h__
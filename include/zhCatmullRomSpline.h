@@ -37,6 +37,11 @@ namespace zh
 /**
 * @brief Generic implementation of a Catmull-Rom spline,
 * suitable for interpolating between key-frame values.
+*
+* Points are evaluated with an inline cubic Hermite basis.
+* Optionally, per-segment polynomial coefficients can be baked
+* when tangents are computed (see setBakeCoefficients()), in which case
+* evaluating a point is a single Horner step per element.
 */
 template <typename T>
 class CatmullRomSpline
@@ -47,25 +52,8 @@ public:
 	/**
 	* Constructor.
 	*/
-	CatmullRomSpline()
+	CatmullRomSpline() : mBakeCoeffs(false)
 	{
-		mCoeffs = Matrix(4);
-		mCoeffs.set( 0, 0, 2 );
-		mCoeffs.set( 0, 1, -2 );
-		mCoeffs.set( 0, 2, 1 );
-		mCoeffs.set( 0, 3, 1 );
-		mCoeffs.set( 1, 0, -3 );
-		mCoeffs.set( 1, 1, 3 );
-		mCoeffs.set( 1, 2, -2 );
-		mCoeffs.set( 1, 3, -1 );
-		mCoeffs.set( 2, 0, 0 );
-		mCoeffs.set( 2, 1, 0 );
-		mCoeffs.set( 2, 2, 1 );
-		mCoeffs.set( 2, 3, 0 );
-		mCoeffs.set( 3, 0, 1 );
-		mCoeffs.set( 3, 1, 0 );
-		mCoeffs.set( 3, 2, 0 );
-		mCoeffs.set( 3, 3, 0 );
 	}
 
 	/**
@@ -81,6 +69,7 @@ public:
 	void addControlPoint( const T& pt )
 	{
 		mCtrlPoints.push_back(pt);
+		_invalidate();
 	}
 
 	/**
@@ -89,6 +78,7 @@ public:
 	void clearControlPoints()
 	{
 		mCtrlPoints.clear();
+		_invalidate();
 	}
 
 	/**
@@ -110,6 +100,7 @@ public:
 		zhAssert( index < getNumControlPoints() );
 
 		mCtrlPoints[index] = pt;
+		_invalidate();
 	}
 
 	/**
@@ -131,6 +122,39 @@ public:
 		return mCtrlPoints.size();
 	}
 
+	/**
+	* Returns true if per-segment polynomial coefficients are baked
+	* when tangents are computed, otherwise false.
+	*/
+	bool getBakeCoefficients() const
+	{
+		return mBakeCoeffs;
+	}
+
+	/**
+	* Specifies whether per-segment polynomial coefficients should be baked
+	* when tangents are computed. Baked coefficients make evaluation cheaper
+	* at the cost of storing four values per segment.
+	*/
+	void setBakeCoefficients( bool bake = true )
+	{
+		mBakeCoeffs = bake;
+
+		if( !mBakeCoeffs )
+			mCoeffs.clear();
+		else if( mTangents.size() == getNumControlPoints() )
+			_bakeCoefficients();
+	}
+
+	/**
+	* Returns true if per-segment polynomial coefficients
+	* are currently baked, otherwise false.
+	*/
+	bool hasBakedCoefficients() const
+	{
+		return mCtrlPoints.size() > 1 && mCoeffs.size() == 4 * ( mCtrlPoints.size() - 1 );
+	}
+
 	/**
 	* Gets a point on the spline computed
 	* by interpolating between control points nearest to the
@@ -143,15 +167,10 @@ public:
 	*/
 	T getPoint( float t ) const
 	{
-		// compute left-hand control point index
-        float fcpi = t * ( float )( mCtrlPoints.size() - 1 );
-        unsigned int cpi = ( unsigned int )fcpi;
-		if( cpi >= mCtrlPoints.size() ) cpi = mCtrlPoints.size() - 1;
-        
-		// compute interp. param.
-        t = fcpi - ( float )cpi;
+		unsigned int cpi;
+		_getSegment( t, cpi, t );
 
-        return getPoint( cpi, t );
+		return getPoint( cpi, t );
 	}
 
 	/**
@@ -164,40 +183,100 @@ public:
 	* @return Interpolated point.
 	*/
 	T getPoint( unsigned int index, float t ) const
+	{
+		T pt;
+		getPoint( index, t, pt );
+
+		return pt;
+	}
+
+	/**
+	* Gets a point on the spline computed
+	* by interpolating between the control point at the specified index
+	* and its right-hand neighbor. This variant writes into an existing
+	* point and doesn't allocate if the point already has the right size.
+	*
+	* param index Index of the left-hand control point.
+	* @param t Interpolation parameter.
+	* @param pt Interpolated point.
+	*/
+	void getPoint( unsigned int index, float t, T& pt ) const
 	{
 		zhAssert( mTangents.size() == getNumControlPoints() );
 
 		if( index >= mCtrlPoints.size() - 1 )
-			return mCtrlPoints[ mCtrlPoints.size() - 1 ];
+		{
+			pt = mCtrlPoints[ mCtrlPoints.size() - 1 ];
+			return;
+		}
 
 		if( zhEqualf( t, 0 ) )
-			return mCtrlPoints[index];
+		{
+			pt = mCtrlPoints[index];
+			return;
+		}
 		else if( zhEqualf( t, 1 ) )
-			return mCtrlPoints[index+1];
+		{
+			pt = mCtrlPoints[index+1];
+			return;
+		}
+
+		const T& cpt1 = mCtrlPoints[index];
+		if( pt.size() != cpt1.size() )
+			pt = cpt1;
 
+		if( hasBakedCoefficients() )
+		{
+			const T& a = mCoeffs[4*index];
+			const T& b = mCoeffs[4*index+1];
+			const T& c = mCoeffs[4*index+2];
+			const T& d = mCoeffs[4*index+3];
+
+			for( unsigned int ei = 0; ei < pt.size(); ++ei )
+				pt.set( ei, ( ( a.get(ei) * t + b.get(ei) ) * t + c.get(ei) ) * t + d.get(ei) );
+
+			return;
+		}
+
+		// cubic Hermite basis
 		float t2 = t*t;
-		Vector tv(4);
-		tv.set( 0, t2*t );
-		tv.set( 1, t2 );
-		tv.set( 2, t );
-		tv.set( 3, 1 );
-		tv *= mCoeffs;
+		float h1 = ( 2.f*t - 3.f ) * t2 + 1.f,
+			h2 = ( 3.f - 2.f*t ) * t2,
+			h3 = ( ( t - 2.f ) * t + 1.f ) * t,
+			h4 = ( t - 1.f ) * t2;
 
-		const T& cpt1 = mCtrlPoints[index];
 		const T& cpt2 = mCtrlPoints[index+1];
 		const T& tan1 = mTangents[index];
 		const T& tan2 = mTangents[index+1];
-		T pt = cpt1;
 
-		for( unsigned int ei = 0; ei < cpt1.size(); ++ei )
+		for( unsigned int ei = 0; ei < pt.size(); ++ei )
 		{
-			pt.set( ei, tv.get(0) * cpt1.get(ei) +
-				tv.get(1) * cpt2.get(ei) +
-				tv.get(2) * tan1.get(ei) +
-				tv.get(3) * tan2.get(ei) );
+			pt.set( ei, h1 * cpt1.get(ei) +
+				h2 * cpt2.get(ei) +
+				h3 * tan1.get(ei) +
+				h4 * tan2.get(ei) );
 		}
+	}
 
-		return pt;
+	/**
+	* Gets points on the spline at multiple values of
+	* the t parameter (normalized to range 0-1).
+	* This is meant for resampling the whole curve.
+	*
+	* @param times Interpolation parameters.
+	* @param points Interpolated points.
+	*/
+	void getPoints( const std::vector<float>& times, std::vector<T>& points ) const
+	{
+		points.resize( times.size() );
+
+		unsigned int cpi;
+		float t;
+		for( unsigned int ti = 0; ti < times.size(); ++ti )
+		{
+			_getSegment( times[ti], cpi, t );
+			getPoint( cpi, t, points[ti] );
+		}
 	}
 
 	/**
@@ -212,15 +291,10 @@ public:
 	*/
 	T getTangent( float t ) const
 	{
-		// compute left-hand control point index
-        float fcpi = t * ( float )( mCtrlPoints.size() - 1 );
-        unsigned int cpi = ( unsigned int )fcpi;
-		if( cpi >= mCtrlPoints.size() ) cpi = mCtrlPoints.size() - 1;
-        
-		// compute interp. param.
-        t = fcpi - ( float )cpi;
+		unsigned int cpi;
+		_getSegment( t, cpi, t );
 
-        return getTangent( cpi, t );
+		return getTangent( cpi, t );
 	}
 
 	/**
@@ -244,13 +318,12 @@ public:
 		else if( zhEqualf( t, 1 ) )
 			return mTangents[index+1];
 
+		// derivative of the cubic Hermite basis
 		float t2 = t*t;
-		Vector tv(4);
-		tv.set( 0, 3.f*t2 );
-		tv.set( 1, 2.f*t );
-		tv.set( 2, 1 );
-		tv.set( 3, 0 );
-		tv *= mCoeffs;
+		float h1 = 6.f*t2 - 6.f*t,
+			h2 = 6.f*t - 6.f*t2,
+			h3 = 3.f*t2 - 4.f*t + 1.f,
+			h4 = 3.f*t2 - 2.f*t;
 
 		const T& cpt1 = mCtrlPoints[index];
 		const T& cpt2 = mCtrlPoints[index+1];
@@ -260,10 +333,10 @@ public:
 
 		for( unsigned int ei = 0; ei < tang.size(); ++ei )
 		{
-			tang.set( ei, tv.get(0) * cpt1.get(ei) +
-				tv.get(1) * cpt2.get(ei) +
-				tv.get(2) * tan1.get(ei) +
-				tv.get(3) * tan2.get(ei) );
+			tang.set( ei, h1 * cpt1.get(ei) +
+				h2 * cpt2.get(ei) +
+				h3 * tan1.get(ei) +
+				h4 * tan2.get(ei) );
 		}
 
 		return tang;
@@ -308,13 +381,65 @@ public:
 				mTangents[cpi] = ( mCtrlPoints[cpi+1] - mCtrlPoints[cpi-1] ) * 0.5f;
 			}
 		}
+
+		if(mBakeCoeffs)
+			_bakeCoefficients();
 	}
 
 private:
 
-	Matrix mCoeffs;
+	void _invalidate()
+	{
+		mTangents.clear();
+		mCoeffs.clear();
+	}
+
+	void _getSegment( float u, unsigned int& index, float& t ) const
+	{
+		// compute left-hand control point index
+		float fcpi = u * ( float )( mCtrlPoints.size() - 1 );
+		index = ( unsigned int )fcpi;
+		if( index >= mCtrlPoints.size() ) index = mCtrlPoints.size() - 1;
+
+		// compute interp. param.
+		t = fcpi - ( float )index;
+	}
+
+	void _bakeCoefficients()
+	{
+		unsigned int ncpts = getNumControlPoints();
+		if( ncpts < 2 )
+			return;
+
+		// p(t) = ( ( a*t + b )*t + c )*t + d,
+		// where [a b c d] = Hermite basis * [p0 p1 m0 m1]
+		static const float hermite_elems[] =
+		{
+			2.f, -2.f, 1.f, 1.f,
+			-3.f, 3.f, -2.f, -1.f,
+			0.f, 0.f, 1.f, 0.f,
+			1.f, 0.f, 0.f, 0.f
+		};
+		const MatrixN<4> hermite(hermite_elems);
+
+		mCoeffs.resize( 4 * ( ncpts - 1 ) );
+		for( unsigned int cpi = 0; cpi < ncpts - 1; ++cpi )
+		{
+			const T* geom[4] = { &mCtrlPoints[cpi], &mCtrlPoints[cpi+1],
+				&mTangents[cpi], &mTangents[cpi+1] };
+			T* coeffs[4] = { &mCoeffs[4*cpi], &mCoeffs[4*cpi+1],
+				&mCoeffs[4*cpi+2], &mCoeffs[4*cpi+3] };
+
+			for( unsigned int ci = 0; ci < 4; ++ci )
+				*coeffs[ci] = mCtrlPoints[cpi];
+			hermite.transform( geom, coeffs );
+		}
+	}
+
 	std::vector<T> mCtrlPoints;
 	std::vector<T> mTangents;
+	bool mBakeCoeffs;
+	std::vector<T> mCoeffs; ///< Baked segment coefficients (a, b, c, d per segment).
 
 };
 
@@ -356,6 +481,7 @@ public:
 	void clearControlPoints()
 	{
 		mCtrlPoints.clear();
+		mTangents.clear();
 	}
 
 	/**
@@ -377,6 +503,7 @@ public:
 		zhAssert( index < getNumControlPoints() );
 
 		mCtrlPoints[index] = pt;
+		mTangents.clear();
 	}
 
 	/**
@@ -449,6 +576,22 @@ public:
 		return cpt1.squad( tan1, tan2, cpt2, t );
 	}
 
+	/**
+	* Gets points on the spline at multiple values of
+	* the t parameter (normalized to range 0-1).
+	* This is meant for resampling the whole curve.
+	*
+	* @param times Interpolation parameters.
+	* @param points Interpolated points.
+	*/
+	void getPoints( const std::vector<float>& times, std::vector<Quat>& points ) const
+	{
+		points.resize( times.size() );
+
+		for( unsigned int ti = 0; ti < times.size(); ++ti )
+			points[ti] = getPoint( times[ti] );
+	}
+
 	/**
 	* Gets a tangent on the spline computed
 	* by interpolating between tangents at the control points
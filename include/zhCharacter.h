@@ -0,0 +1,161 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhCharacter_h__
+#define __zhCharacter_h__
+
+#include "zhPrereq.h"
+#include "zhSkeleton.h"
+#include "zhAnimationTree.h"
+#include "zhLODPolicy.h"
+#include "zhScratchArena.h"
+#include "zhEventQueue.h"
+
+namespace zh
+{
+
+/**
+* @brief Class representing an animated character instance.
+*
+* Each character owns its own skeleton pose and animation tree
+* state, while animation sets, animation spaces and parametrizations
+* referenced by the tree are shared among all characters.
+* Characters are created and updated by AnimationSystem.
+*
+* Character updates may run in parallel on worker threads
+* (see AnimationSystem::setNumWorkerThreads). During the update
+* only the character's own skeleton and animation tree are modified,
+* while shared animation data is only read. Events emitted by nodes
+* in a character tree are deferred into the character's own event queue
+* and delivered to listeners on the calling thread once all characters
+* have been updated, in the order of characters (see EventQueue).
+* Temporaries allocated during the update are drawn from the character's
+* own scratch arena (see ScratchArena).
+*
+* Animation detail is selected by a level-of-detail policy
+* based on the character importance (see LODPolicy).
+*/
+class zhDeclSpec Character
+{
+
+public:
+
+	/**
+	* Constructor.
+	*
+	* @param name Character name.
+	* @param skel Character skeleton. The character takes ownership of it.
+	* @param animTree Character animation tree. The character takes ownership of it.
+	*/
+	Character( const std::string& name, Skeleton* skel, AnimationTree* animTree );
+
+	/**
+	* Destructor.
+	*/
+	~Character();
+
+	/**
+	* Gets the character name.
+	*/
+	const std::string& getName() const;
+
+	/**
+	* Gets the character skeleton.
+	*/
+	Skeleton* getSkeleton() const;
+
+	/**
+	* Gets the animation tree driving the character.
+	*/
+	AnimationTree* getAnimationTree() const;
+
+	/**
+	* Gets the character importance, which determines
+	* the animation level of detail.
+	*/
+	float getImportance() const;
+
+	/**
+	* Sets the character importance, which determines
+	* the animation level of detail.
+	*/
+	void setImportance( float importance );
+
+	/**
+	* Gets the level-of-detail policy used for the character.
+	*/
+	const LODPolicy* getLODPolicy() const;
+
+	/**
+	* Sets the level-of-detail policy used for the character.
+	*
+	* @param lodPolicy Pointer to the policy. The policy is not owned
+	* by the character and can be shared among characters. If NULL,
+	* the character is always animated at full detail.
+	*/
+	void setLODPolicy( const LODPolicy* lodPolicy );
+
+	/**
+	* Updates the animation tree with elapsed time, applies
+	* it to the character skeleton and solves IK.
+	*
+	* @param dt Elapsed time.
+	* @remark At reduced update rates, the animation tree is evaluated
+	* one update interval ahead and the character pose is interpolated
+	* between the two most recently evaluated poses.
+	*/
+	void update( float dt );
+
+	/**
+	* Gets the queue into which events emitted during
+	* the character update are deferred.
+	*/
+	EventQueue& _getEventQueue();
+
+private:
+
+	void _storeEvalPose();
+	void _interpolateEvalPose( float t );
+
+	std::string mName;
+	Skeleton* mSkel;
+	AnimationTree* mAnimTree;
+
+	float mImportance;
+	const LODPolicy* mLODPolicy;
+
+	// Poses evaluated at reduced update rate
+	bool mHasEvalPose;
+	float mEvalTime; ///< Time since the previous evaluated pose.
+	float mEvalInterval; ///< Time between the previous and next evaluated pose.
+	std::vector<Vector3> mPrevPositions, mNextPositions;
+	std::vector<Quat> mPrevOrients, mNextOrients;
+	std::vector<Vector3> mPrevScales, mNextScales;
+
+	ScratchArena mScratchArena; ///< Arena for temporaries allocated during update().
+	EventQueue mEventQueue; ///< Queue for events deferred during update().
+
+};
+
+}
+
+#endif // __zhCharacter_h__
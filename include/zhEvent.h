@@ -30,6 +30,7 @@ SOFTWARE.
 
 #include "zhPrereq.h"
 #include "zhFunctor.h"
+#include "zhEventQueue.h"
 
 namespace zh
 {
@@ -61,6 +62,13 @@ public:
 		mEmitter = emitter;
 	}
 
+	/**
+	* Destructor.
+	*/
+	virtual ~Event()
+	{
+	}
+
 	/**
 	* Gets the emitter for this event.
 	*
@@ -72,11 +80,34 @@ public:
 	}
 
 	/**
-	* Emits the event.
+	* Emits the event. If a deferred event queue is set,
+	* the event is queued instead and delivered when the queue is flushed.
 	*/
 	virtual void emit()
 	{
-		mEmitter->_emitEvent( (const Evt&)*this );
+		EventQueue* queue = EventQueue::GetDeferredQueue();
+		if( queue != NULL )
+			queue->enqueue( static_cast<const Evt&>(*this) );
+		else
+			mEmitter->_emitEvent( static_cast<const Evt&>(*this) );
+	}
+
+	/**
+	* Creates a copy of the event, for deferred delivery.
+	* Classes derived from an event class should override this,
+	* so that deferred events aren't sliced.
+	*
+	* @param buffer Buffer in which the copy is created if it fits.
+	* @param bufferSize Size of the buffer in bytes.
+	* @return Pointer to the copy, which is allocated on the heap
+	* if it doesn't fit into the buffer.
+	*/
+	virtual Evt* _clone( void* buffer, size_t bufferSize ) const
+	{
+		if( sizeof(Evt) <= bufferSize )
+			return new(buffer) Evt( static_cast<const Evt&>(*this) );
+
+		return new Evt( static_cast<const Evt&>(*this) );
 	}
 
 protected:
@@ -0,0 +1,199 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhEventQueue_h__
+#define __zhEventQueue_h__
+
+#include "zhPrereq.h"
+
+#include <new>
+
+#if zhMultiThreading_Enabled
+#include <boost/atomic.hpp>
+#endif
+
+#define zhEventQueue_SlotSize 64
+
+namespace zh
+{
+
+/**
+* @brief Queue of events awaiting delivery.
+*
+* While a queue is set as the deferred queue (see SetDeferredQueue()),
+* emitted events are copied into the queue instead of being delivered
+* to listeners. The queued events are then delivered in one batch
+* by calling flush(). The deferred queue is set per thread.
+*
+* Events are stored in pre-allocated slots. If multi-threading is enabled,
+* events can be queued from multiple threads at once - slots are
+* claimed without locking, and only events that don't fit into the slots
+* are queued under a lock. Events queued by one thread are delivered
+* in the order they were queued. The queue must not be flushed while
+* events are being queued.
+*/
+class zhDeclSpec EventQueue
+{
+
+public:
+
+	/**
+	* Constructor.
+	*
+	* @param capacity Number of pre-allocated event slots.
+	*/
+	EventQueue( unsigned int capacity = 256 );
+
+	/**
+	* Destructor.
+	*/
+	~EventQueue();
+
+	/**
+	* Gets the number of pre-allocated event slots.
+	*/
+	unsigned int getCapacity() const;
+
+	/**
+	* Sets the number of pre-allocated event slots.
+	*
+	* @remark The queue grows automatically at flush time
+	* if more events were queued than there are slots.
+	*/
+	void setCapacity( unsigned int capacity );
+
+	/**
+	* Gets the number of queued events.
+	*/
+	unsigned int getNumEvents() const;
+
+	/**
+	* Queues an event for delivery.
+	*
+	* @param evt Event object. The event is copied (see Event::_clone()).
+	*/
+	template <class Evt>
+	void enqueue( const Evt& evt )
+	{
+#if zhMultiThreading_Enabled
+		unsigned int pos = mNumQueued.fetch_add(1);
+#else
+		unsigned int pos = mNumQueued++;
+#endif
+
+		if( pos < mSlots.size() )
+		{
+			_initSlot( mSlots[pos], evt, zhEventQueue_SlotSize );
+		}
+		else
+		{
+			// out of slots, overflowing events are allocated
+			// separately, as the overflow storage may be reallocated
+			zhLock_Mutex;
+			mOverflow.push_back( Slot() );
+			_initSlot( mOverflow.back(), evt, 0 );
+			zhUnlock_Mutex;
+		}
+	}
+
+	/**
+	* Delivers all queued events to their listeners
+	* and empties the queue. If another queue is set as the deferred queue,
+	* the events are moved into that queue instead.
+	*
+	* @remark Don't flush the queue while it is the deferred queue,
+	* as events emitted by listeners would be queued again.
+	*/
+	void flush();
+
+	/**
+	* Empties the queue without delivering the events.
+	*/
+	void clear();
+
+	/**
+	* Gets the queue into which events emitted on the current thread
+	* are deferred, or NULL if events are delivered immediately.
+	*/
+	static EventQueue* GetDeferredQueue();
+
+	/**
+	* Sets the queue into which events emitted on the current thread
+	* are deferred.
+	*
+	* @param queue Pointer to the queue or NULL
+	* if events should be delivered immediately.
+	*/
+	static void SetDeferredQueue( EventQueue* queue );
+
+private:
+
+	struct Slot
+	{
+		void (*mHandler)( Slot& slot, bool deliver ); ///< Delivers and/or destroys the event.
+		void* mEvt; ///< Event object, either in the buffer or on the heap.
+		union
+		{
+			double mAlign;
+			char mBuffer[zhEventQueue_SlotSize];
+		} mData;
+	};
+
+	template <class Evt>
+	static void _initSlot( Slot& slot, const Evt& evt, size_t bufferSize )
+	{
+		slot.mHandler = &EventQueue::_handleSlot<Evt>;
+		slot.mEvt = evt._clone( slot.mData.mBuffer, bufferSize );
+	}
+
+	template <class Evt>
+	static void _handleSlot( Slot& slot, bool deliver )
+	{
+		Evt* evt = static_cast<Evt*>( slot.mEvt );
+
+		if(deliver)
+			evt->emit();
+
+		// event is in the buffer if the clone was made there
+		const char* evt_addr = reinterpret_cast<const char*>( slot.mEvt );
+		if( evt_addr >= slot.mData.mBuffer && evt_addr < slot.mData.mBuffer + zhEventQueue_SlotSize )
+			evt->~Evt();
+		else
+			delete evt;
+	}
+
+	void _release( bool deliver );
+
+	std::vector<Slot> mSlots;
+	std::vector<Slot> mOverflow;
+#if zhMultiThreading_Enabled
+	boost::atomic<unsigned int> mNumQueued;
+#else
+	unsigned int mNumQueued;
+#endif
+	zhDeclare_Mutex
+
+};
+
+}
+
+#endif // __zhEventQueue_h__
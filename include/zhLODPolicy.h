@@ -0,0 +1,136 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhLODPolicy_h__
+#define __zhLODPolicy_h__
+
+#include "zhPrereq.h"
+#include "zhBoneMask.h"
+
+namespace zh
+{
+
+class Skeleton;
+
+/**
+* @brief Animation level of detail.
+*/
+struct zhDeclSpec LODLevel
+{
+	float minImportance; ///< Lowest character importance at which this level is used.
+	float updateInterval; ///< Time between animation tree evaluations (0 means every update).
+	bool solveIK; ///< If false, IK solvers are not run.
+	bool emitAnnotations; ///< If false, animation nodes do not emit annotation events.
+	BoneMask boneMask; ///< Bones which are not animated.
+
+	/**
+	* Constructor.
+	*/
+	LODLevel( float minImportance = 0, float updateInterval = 0,
+		bool solveIK = true, bool emitAnnotations = true );
+};
+
+/**
+* @brief Class which selects animation level of detail for characters.
+*
+* Levels of detail reduce the cost of animating unimportant
+* (e.g. distant or off-screen) characters. Each character has an importance
+* value and is animated at the level with the highest minimum importance
+* not exceeding it. Lower levels can evaluate the animation tree
+* at a reduced rate (the character pose is interpolated in between),
+* skip IK and annotation events, and animate only a subset of bones.
+*
+* If the policy has no levels, characters are animated at full detail.
+*/
+class zhDeclSpec LODPolicy
+{
+
+public:
+
+	/**
+	* Constructor.
+	*/
+	LODPolicy();
+
+	/**
+	* Destructor.
+	*/
+	~LODPolicy();
+
+	/**
+	* Adds a level of detail.
+	*
+	* @param level Level of detail.
+	* @return Level index. Levels are ordered by descending minimum importance.
+	*/
+	unsigned int addLevel( const LODLevel& level );
+
+	/**
+	* Removes the level of detail at the specified index.
+	*/
+	void removeLevel( unsigned int index );
+
+	/**
+	* Removes all levels of detail.
+	*/
+	void removeAllLevels();
+
+	/**
+	* Gets the level of detail at the specified index.
+	*/
+	const LODLevel& getLevel( unsigned int index ) const;
+
+	/**
+	* Gets the number of levels of detail.
+	*/
+	unsigned int getNumLevels() const;
+
+	/**
+	* Selects the level of detail for the specified character importance.
+	*
+	* @param importance Character importance.
+	* @return Pointer to the level of detail or NULL
+	* if the character should be animated at full detail.
+	*/
+	const LODLevel* selectLevel( float importance ) const;
+
+	/**
+	* Creates a mask which excludes all bones of the skeleton
+	* except the specified ones.
+	*
+	* @param skel Pointer to the skeleton.
+	* @param boneIds IDs of the bones which should be animated
+	* (e.g. spine and limbs, but not fingers).
+	* @param boneMask Bone mask.
+	*/
+	static void CreateBoneMask( const Skeleton* skel, const std::set<unsigned short>& boneIds,
+		BoneMask& boneMask );
+
+private:
+
+	std::vector<LODLevel> mLevels;
+
+};
+
+}
+
+#endif // __zhLODPolicy_h__
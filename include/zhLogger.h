@@ -68,6 +68,8 @@ private:
 	FILE* mLogfile;
 	Timer mTmr;
 
+	zhDeclare_Mutex
+
 };
 
 }
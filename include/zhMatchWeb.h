@@ -355,6 +355,10 @@ public:
 
 	/**
 	* Gets the animation distance grid.
+	*
+	* @return Distance grid at the match web's sample rate, or NULL
+	* if the match web hasn't been built or no paths were found
+	* at low resolution (in which case the full-rate grid isn't built).
 	*/
 	AnimationDistanceGrid* getDistanceGrid() { return mDistGrid; }
 
@@ -409,6 +413,18 @@ public:
 
 protected:
 
+	/**
+	* Builds minima chains and bridges between them
+	* from local minima of the distance grid.
+	*
+	* @param grid Animation distance grid, with local minima already found.
+	* @param minDist Maximum distance value for local minima, normalized.
+	* @param minChainLength Minimum length of a minima chain.
+	* @param maxBridgeLength Maximum length of a bridge between a pair
+	* of minima chains.
+	*/
+	void _buildPaths( AnimationDistanceGrid* grid, float minDist, float minChainLength, float maxBridgeLength );
+
 	void _computePathAABB( unsigned int pathIndex, unsigned int& lBound, unsigned int& bBound, 
 		unsigned int& rBound, unsigned int& tBound, unsigned int extendBy = 0 ) const;
 	
@@ -26,12 +26,17 @@ SOFTWARE.
 #include "zhPrereq.h"
 #include "zhVector.h"
 
+#define zhMatrix_InlineSize 4
+
 namespace zh
 {
 
 /**
 * NxN square matrix class. Also contains a static method for solving
 * linear equations.
+*
+* Matrices of up to zhMatrix_InlineSize x zhMatrix_InlineSize elements
+* are stored inline, larger ones are allocated on the heap.
 */
 class zhDeclSpec Matrix
 {
@@ -169,8 +174,113 @@ public:
 
 private:
 
+	void _resize( unsigned int n );
+
 	unsigned int mN; ///< Matrix size.
+	unsigned int mCapacity; ///< Number of elements that fit into the current storage.
 	float* mMat; ///< Matrix elements.
+	float mBuffer[ zhMatrix_InlineSize * zhMatrix_InlineSize ]; ///< Inline storage for small matrices.
+
+};
+
+/**
+* @brief Fixed-size NxN square matrix, stored inline.
+*
+* Meant for small constant matrices used in inner loops,
+* such as spline basis matrices.
+*/
+template <unsigned int N>
+class MatrixN
+{
+
+public:
+
+	/**
+	* Constructor. Creates an identity matrix.
+	*/
+	MatrixN()
+	{
+		identity();
+	}
+
+	/**
+	* Constructor. Creates a matrix from an array of elements in row-major order.
+	*/
+	explicit MatrixN( const float* elems )
+	{
+		memcpy( mMat, elems, N * N * sizeof(float) );
+	}
+
+	/**
+	* Gets the matrix size.
+	*/
+	static unsigned int size()
+	{
+		return N;
+	}
+
+	/**
+	* Gets an element of the matrix by index.
+	*/
+	float get( unsigned int i, unsigned int j ) const
+	{
+		zhAssert( i < N && j < N );
+
+		return mMat[i*N+j];
+	}
+
+	/**
+	* Sets an element of the matrix by index.
+	*/
+	void set( unsigned int i, unsigned int j, float x )
+	{
+		zhAssert( i < N && j < N );
+
+		mMat[i*N+j] = x;
+	}
+
+	/**
+	* Sets the matrix to identity.
+	*/
+	MatrixN& identity()
+	{
+		for( unsigned int i = 0; i < N; ++i )
+			for( unsigned int j = 0; j < N; ++j )
+				mMat[i*N+j] = i == j ? 1.f : 0.f;
+
+		return *this;
+	}
+
+	/**
+	* Multiplies the matrix with a column of N vectors
+	* (each row of the result is a linear combination of the input vectors).
+	* Vector type must provide size(), get() and set(),
+	* and output vectors must already have the right size.
+	*
+	* @param in Array of N input vectors.
+	* @param out Array of N output vectors.
+	*/
+	template <class T>
+	void transform( const T* const* in, T* const* out ) const
+	{
+		unsigned int n = in[0]->size();
+
+		for( unsigned int i = 0; i < N; ++i )
+		{
+			for( unsigned int ei = 0; ei < n; ++ei )
+			{
+				float x = 0;
+				for( unsigned int j = 0; j < N; ++j )
+					x += mMat[i*N+j] * in[j]->get(ei);
+
+				out[i]->set( ei, x );
+			}
+		}
+	}
+
+private:
+
+	float mMat[N*N]; ///< Matrix elements.
 
 };
 
@@ -0,0 +1,128 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhMoverCurve_h__
+#define __zhMoverCurve_h__
+
+#include "zhPrereq.h"
+#include "zhMath.h"
+
+namespace zh
+{
+
+class BoneAnimationTrack;
+
+/**
+* @brief Root motion (mover) of an animation, precomputed
+* into a uniformly sampled curve.
+*
+* Each sample holds the root position and orientation. Because samples
+* are uniform, the curve is sampled in constant time without searching
+* key-frames. Between samples, positions are interpolated linearly and
+* orientations spherically, so the result only approximates sampling
+* the root track directly; the error shrinks as the sample rate increases.
+*
+* @remark Root positions are relative to the root bone initial position,
+* i.e. they are root track translations. The curve assumes the root bone
+* initial orientation is identity.
+*/
+class zhDeclSpec MoverCurve
+{
+
+public:
+
+	/**
+	* Constructor.
+	*/
+	MoverCurve();
+
+	/**
+	* Builds the curve by sampling the specified root track.
+	*
+	* @param rootTrack Root bone animation track.
+	* @param length Animation length.
+	* @param sampleRate Approximate number of samples per second.
+	* The actual sample rate is adjusted so that the last sample
+	* falls exactly at the end of the animation.
+	*/
+	void build( const BoneAnimationTrack* rootTrack, float length, float sampleRate );
+
+	/**
+	* Removes all samples from the curve.
+	*/
+	void clear();
+
+	/**
+	* Returns true if the curve has no samples, otherwise false.
+	*/
+	bool isEmpty() const;
+
+	/**
+	* Gets the ID of the root bone whose track the curve was built from.
+	*/
+	unsigned short getBoneId() const;
+
+	/**
+	* Gets the length of the sampled animation.
+	*/
+	float getLength() const;
+
+	/**
+	* Gets the number of samples per second.
+	*/
+	float getSampleRate() const;
+
+	/**
+	* Gets the number of samples.
+	*/
+	unsigned int getNumSamples() const;
+
+	/**
+	* Samples the root transformation at the specified time.
+	*
+	* @param time Animation time. It is clamped to animation length.
+	* @param pos Root position (relative to root bone initial position).
+	* @param orient Root orientation.
+	*/
+	void sample( float time, Vector3& pos, Quat& orient ) const;
+
+private:
+
+	struct Sample
+	{
+		Vector3 mPos;
+		Quat mOrient;
+	};
+
+	// time to sample index and interpolation parameter
+	unsigned int _getSampleIndex( float time, float& t ) const;
+
+	unsigned short mBoneId;
+	float mLength;
+	float mSampleRate;
+	std::vector<Sample> mSamples;
+
+};
+
+}
+
+#endif // __zhMoverCurve_h__
@@ -0,0 +1,265 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhPose_h__
+#define __zhPose_h__
+
+#include "zhPrereq.h"
+#include "zhMath.h"
+#include "zhBoneMask.h"
+
+namespace zh
+{
+
+class Skeleton;
+
+/**
+* @brief Class representing a skeletal pose, stored as
+* a flat array of bone transformations.
+*
+* Bone transformations are relative to the initial pose and have
+* the same meaning as key-frame values in a BoneAnimationTrack
+* (identity transformation leaves the bone in its initial pose).
+* Bones are indexed the same way as in the compiled topology
+* of the skeleton from which the pose layout has been created
+* (see Skeleton::getBoneByIndex), but the pose never touches
+* skeleton bones, so poses can be evaluated concurrently.
+*/
+class zhDeclSpec Pose
+{
+
+public:
+
+	/**
+	* Constructor.
+	*/
+	Pose();
+
+	/**
+	* Constructor.
+	*
+	* @param skel Skeleton defining the pose layout.
+	*/
+	Pose( const Skeleton* skel );
+
+	/**
+	* Destructor.
+	*/
+	~Pose();
+
+	/**
+	* Initializes the pose layout from the specified skeleton
+	* and resets all transformations to identity.
+	*
+	* @param skel Skeleton defining the pose layout.
+	* @remark Memory is only allocated if the layout grows,
+	* so reinitializing the pose with the same skeleton is cheap.
+	*/
+	void init( const Skeleton* skel );
+
+	/**
+	* Returns true if the pose layout matches the current
+	* compiled topology of the specified skeleton, otherwise false.
+	*/
+	bool hasLayout( const Skeleton* skel ) const;
+
+	/**
+	* Gets the skeleton defining the pose layout.
+	*/
+	const Skeleton* getSkeleton() const;
+
+	/**
+	* Gets the number of bones in the pose.
+	*/
+	unsigned int getNumBones() const;
+
+	/**
+	* Gets the index of the specified bone in the pose.
+	*
+	* @param boneId Bone ID.
+	* @return Bone index or UINT_MAX if the bone is not in the pose.
+	*/
+	unsigned int getBoneIndex( unsigned short boneId ) const;
+
+	/**
+	* Gets the ID of the bone at the specified index.
+	*/
+	unsigned short getBoneId( unsigned int index ) const;
+
+	/**
+	* Gets the translation of the bone at the specified index.
+	*/
+	const Vector3& getTranslation( unsigned int index ) const;
+
+	/**
+	* Sets the translation of the bone at the specified index.
+	*/
+	void setTranslation( unsigned int index, const Vector3& trans );
+
+	/**
+	* Gets the rotation of the bone at the specified index.
+	*/
+	const Quat& getRotation( unsigned int index ) const;
+
+	/**
+	* Sets the rotation of the bone at the specified index.
+	*/
+	void setRotation( unsigned int index, const Quat& rot );
+
+	/**
+	* Gets the scale of the bone at the specified index.
+	*/
+	const Vector3& getScale( unsigned int index ) const;
+
+	/**
+	* Sets the scale of the bone at the specified index.
+	*/
+	void setScale( unsigned int index, const Vector3& scal );
+
+	/**
+	* Resets all bone transformations to identity.
+	*/
+	void reset();
+
+	/**
+	* Applies the pose to the specified skeleton. This is
+	* equivalent to applying an animation that was sampled into this pose.
+	*
+	* @param skel Pointer to the skeleton. It must have
+	* the same topology as the skeleton defining the pose layout.
+	* @param weight Blend weight with which the pose should be applied.
+	* @param scale Scaling factor applied to the pose.
+	*/
+	void apply( Skeleton* skel, float weight = 1.f, float scale = 1.f ) const;
+
+	/**
+	* Computes world transformations of all bones, as they would be
+	* if the pose were applied to a skeleton reset to the initial pose.
+	* The skeleton defining the pose layout is not modified.
+	*
+	* @param worldPos World positions, indexed by bone index.
+	* @param worldOrient World orientations, indexed by bone index.
+	* @param worldScal World scales, indexed by bone index.
+	* @param scale Scaling factor applied to the pose.
+	*/
+	void computeWorldTransforms( std::vector<Vector3>& worldPos, std::vector<Quat>& worldOrient,
+		std::vector<Vector3>& worldScal, float scale = 1.f ) const;
+
+private:
+
+	const Skeleton* mSkel;
+	std::vector<unsigned short> mBoneIds; ///< Bone IDs, indexed by bone index.
+	std::vector<unsigned int> mBoneIndices; ///< Bone indexes, indexed by bone ID.
+
+	std::vector<Vector3> mTranslations;
+	std::vector<Quat> mRotations;
+	std::vector<Vector3> mScales;
+
+};
+
+/**
+* @brief Class which accumulates weighted poses and applies
+* their blend to a skeleton.
+*
+* Translations and scales are summed with their weights. For rotations,
+* weighted outer products of quaternions are summed, and the blended rotation
+* is computed once when the blend is applied, as the principal eigenvector
+* of the sum (the weighted mean rotation). Because q and -q contribute
+* the same outer product, no quaternion hemisphere needs to be chosen,
+* and the result is independent of the order in which poses
+* are accumulated. Weights are tracked per bone, so bones masked out
+* of some poses are only blended among the poses which animate them.
+*/
+class zhDeclSpec PoseAccumulator
+{
+
+public:
+
+	/**
+	* Constructor.
+	*/
+	PoseAccumulator();
+
+	/**
+	* Destructor.
+	*/
+	~PoseAccumulator();
+
+	/**
+	* Initializes the accumulator layout from the specified skeleton
+	* and resets it.
+	*/
+	void init( const Skeleton* skel );
+
+	/**
+	* Returns true if the accumulator layout matches the current
+	* compiled topology of the specified skeleton, otherwise false.
+	*/
+	bool hasLayout( const Skeleton* skel ) const;
+
+	/**
+	* Clears all accumulated poses.
+	*/
+	void reset();
+
+	/**
+	* Adds the specified pose to the accumulator.
+	*
+	* @param pose Pose. It must have the same layout as the accumulator.
+	* @param weight Blend weight of the pose.
+	* @param boneMask Bone mask. Masked bones are not accumulated.
+	*/
+	void accumulate( const Pose& pose, float weight, const BoneMask& boneMask = BoneMask() );
+
+	/**
+	* Gets the total weight accumulated for the bone at the specified index.
+	*/
+	float getWeight( unsigned int index ) const;
+
+	/**
+	* Applies the blend of accumulated poses to the specified skeleton.
+	* This is equivalent to applying each of the poses with its
+	* weight, except that rotations are averaged rather than composed.
+	*
+	* @param skel Pointer to the skeleton. It must have
+	* the same topology as the skeleton defining the accumulator layout.
+	* @param scale Scaling factor applied to the blended pose.
+	*/
+	void apply( Skeleton* skel, float scale = 1.f ) const;
+
+private:
+
+	static Quat _getMeanRotation( const float* rotMoments ); ///< Computes the mean rotation from accumulated outer products.
+
+	const Skeleton* mSkel;
+	std::vector<unsigned short> mBoneIds; ///< Bone IDs, indexed by bone index.
+
+	std::vector<float> mWeights;
+	std::vector<Vector3> mTranslations;
+	std::vector<float> mRotMoments; ///< Weighted quaternion outer products (upper triangles of 4x4 matrices), 10 per bone.
+	std::vector<Vector3> mScales;
+
+};
+
+}
+
+#endif // __zhPose_h__
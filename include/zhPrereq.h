@@ -40,6 +40,7 @@ SOFTWARE.
 #define zhMultiThreading_Enabled 0
 #define zhMemoryPool_ChunkSize 4096
 #define zhMemoryPool_MaxObjSize 128
+#define zhAllocTracking_Enabled 0 // count global heap allocations made during animation updates (see ScratchArena)
 #define zhAnimationParam_SampleInterpK 10 // k-value used for kNN interpolation of parameter samples in param. animations
 #define zhBlend_TWTimeStep 0.1f // maximum Euler step used in blending with timewarping
 #define zhAnimation_SampleRate 30 // animation sample rate (in frames per second)
@@ -81,6 +82,13 @@ SOFTWARE.
 	#define zhArchType zhArchType_32
 #endif
 
+// SIMD instruction sets
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+	#define zhSSE_Enabled 1
+#else
+	#define zhSSE_Enabled 0
+#endif
+
 // 64-bit int type
 #if zhCompiler == zhCompiler_MSVC
 	typedef __int64 Int64;
@@ -90,6 +98,13 @@ SOFTWARE.
 	typedef unsigned long long UInt64;
 #endif
 
+// thread-local storage
+#if zhCompiler == zhCompiler_MSVC
+	#define zhThreadLocal __declspec( thread )
+#else
+	#define zhThreadLocal __thread
+#endif
+
 // suppress some annoying warnings
 #if zhCompiler == zhCompiler_MSVC
 	#pragma warning( disable : 4251 4267 )
@@ -0,0 +1,226 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhScratchArena_h__
+#define __zhScratchArena_h__
+
+#include "zhPrereq.h"
+
+#include <new>
+
+#define zhScratchArena_BlockSize 16384
+#define zhScratchArena_Alignment 16
+
+namespace zh
+{
+
+/**
+* @brief Linear allocator for short-lived temporaries.
+*
+* Memory is allocated by bumping an offset into pre-allocated blocks
+* and is never freed individually - instead, the whole arena is reset
+* at once when the temporaries are no longer needed. AnimationSystem
+* and Character own one arena each and set it as the current arena
+* (see SetCurrent()) for the duration of their update, resetting it
+* afterwards. Code on the update path draws its temporaries
+* from the current arena, typically through ScratchAllocator.
+*
+* If the temporaries don't fit into the arena, another block is allocated.
+* On reset, blocks are merged into one large enough to hold all of them,
+* so after the first few updates the arena stops touching the heap.
+*
+* The current arena is set per thread, so characters updated
+* on different worker threads use their own arenas.
+*/
+class zhDeclSpec ScratchArena
+{
+
+public:
+
+	/**
+	* Constructor.
+	*
+	* @param blockSize Size of the initially allocated block (in bytes).
+	*/
+	ScratchArena( size_t blockSize = zhScratchArena_BlockSize );
+
+	/**
+	* Destructor.
+	*/
+	~ScratchArena();
+
+	/**
+	* Allocates memory from the arena.
+	*
+	* @param size Size of the memory (in bytes).
+	* @return Pointer to the memory, aligned to zhScratchArena_Alignment bytes.
+	*/
+	void* allocate( size_t size );
+
+	/**
+	* Frees all memory allocated from the arena.
+	*/
+	void reset();
+
+	/**
+	* Gets the size of memory currently allocated from the arena (in bytes).
+	*/
+	size_t getUsedSize() const;
+
+	/**
+	* Gets the total size of the arena's blocks (in bytes).
+	*/
+	size_t getCapacity() const;
+
+	/**
+	* Gets the number of global heap allocations made on this thread
+	* while the arena was current, since the arena was last reset.
+	*
+	* @remark Allocations are only counted if allocation tracking
+	* is enabled (see zhAllocTracking_Enabled), otherwise this is always 0.
+	*/
+	unsigned int getNumHeapAllocs() const;
+
+	/**
+	* Counts a global heap allocation.
+	*/
+	void _countHeapAlloc();
+
+	/**
+	* Gets the arena from which temporaries are allocated on this thread,
+	* or NULL if there is none.
+	*/
+	static ScratchArena* GetCurrent();
+
+	/**
+	* Sets the arena from which temporaries are allocated on this thread.
+	*
+	* @param arena Pointer to the arena or NULL.
+	*/
+	static void SetCurrent( ScratchArena* arena );
+
+private:
+
+	ScratchArena( const ScratchArena& );
+	ScratchArena& operator =( const ScratchArena& );
+
+	void _addBlock( size_t size );
+
+	struct Block
+	{
+		char* mData;
+		size_t mSize;
+	};
+
+	std::vector<Block> mBlocks;
+	unsigned int mCurBlock; ///< Block from which memory is currently allocated.
+	size_t mOffset; ///< Offset of free memory in the current block.
+	size_t mUsedSize;
+	size_t mCapacity;
+	unsigned int mNumHeapAllocs;
+	bool mGrowing; ///< If true, the arena is allocating a block, which isn't counted.
+
+};
+
+/**
+* @brief STL allocator drawing memory from a scratch arena.
+*
+* Deallocation does nothing, as memory is freed when the arena is reset.
+* If there is no arena, memory is allocated from the heap as usual.
+* Containers using this allocator must not outlive the arena's update
+* (e.g. they should only be used for local variables).
+*/
+template <class T>
+class ScratchAllocator
+{
+
+public:
+
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+
+	template <class U>
+	struct rebind
+	{
+		typedef ScratchAllocator<U> other;
+	};
+
+	/**
+	* Constructor.
+	*
+	* @param arena Pointer to the arena, by default the current arena on this thread.
+	*/
+	ScratchAllocator( ScratchArena* arena = ScratchArena::GetCurrent() ) : mArena(arena) { }
+
+	template <class U>
+	ScratchAllocator( const ScratchAllocator<U>& alloc ) : mArena( alloc._getArena() ) { }
+
+	pointer address( reference x ) const { return &x; }
+	const_pointer address( const_reference x ) const { return &x; }
+
+	pointer allocate( size_type n, const void* = 0 )
+	{
+		if( mArena != NULL )
+			return static_cast<pointer>( mArena->allocate( n * sizeof(T) ) );
+
+		return static_cast<pointer>( ::operator new( n * sizeof(T) ) );
+	}
+
+	void deallocate( pointer p, size_type )
+	{
+		if( mArena == NULL )
+			::operator delete(p);
+	}
+
+	size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+	void construct( pointer p, const T& x ) { new(p) T(x); }
+	void destroy( pointer p ) { p->~T(); }
+
+	ScratchArena* _getArena() const { return mArena; }
+
+private:
+
+	ScratchArena* mArena;
+
+};
+
+template <class T, class U>
+inline bool operator ==( const ScratchAllocator<T>& alloc1, const ScratchAllocator<U>& alloc2 )
+{
+	return alloc1._getArena() == alloc2._getArena();
+}
+
+template <class T, class U>
+inline bool operator !=( const ScratchAllocator<T>& alloc1, const ScratchAllocator<U>& alloc2 )
+{
+	return alloc1._getArena() != alloc2._getArena();
+}
+
+}
+
+#endif // __zhScratchArena_h__
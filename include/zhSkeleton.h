@@ -28,6 +28,10 @@ SOFTWARE.
 #include "zhBone.h"
 #include "zhIKSolver.h"
 
+#if zhMultiThreading_Enabled
+#include <boost/atomic.hpp>
+#endif
+
 namespace zh
 {
 
@@ -35,6 +39,12 @@ namespace zh
 * @brief Skeletal animation state class.
 * Holds skeletal pose configuration before it is passed to the renderer.
 * Root bone always has zero ID.
+*
+* Besides the maps of bones by ID and name, the skeleton maintains
+* a compiled topology, in which bones are indexed in parent-before-child
+* order and parent indexes and initial pose are stored in flat arrays.
+* The topology is recompiled on demand whenever the hierarchy
+* or the initial pose changes.
 */
 class zhDeclSpec Skeleton
 {
@@ -246,11 +256,61 @@ public:
 	*/
 	BoneConstIterator getBoneConstIterator() const;
 
+	/**
+	* Gets the bone at the specified index in the compiled topology.
+	* Each bone's index is greater than its parent's index, so iterating
+	* over bones by index visits parents before their children.
+	*
+	* @param index Bone index.
+	* @return Pointer to the bone.
+	*/
+	Bone* getBoneByIndex( unsigned int index ) const;
+
+	/**
+	* Gets the index of the specified bone's parent
+	* in the compiled topology.
+	*
+	* @param index Bone index.
+	* @return Parent index or UINT_MAX if the bone has no parent.
+	*/
+	unsigned int getParentIndex( unsigned int index ) const;
+
+	/**
+	* Gets the array of parent indexes in the compiled topology.
+	*/
+	const std::vector<unsigned int>& getParentIndices() const;
+
+	/**
+	* Gets the array of initial bone positions, indexed by bone index.
+	*/
+	const std::vector<Vector3>& getInitialPositions() const;
+
+	/**
+	* Gets the array of initial bone orientations, indexed by bone index.
+	*/
+	const std::vector<Quat>& getInitialOrientations() const;
+
+	/**
+	* Gets the array of initial bone scales, indexed by bone index.
+	*/
+	const std::vector<Vector3>& getInitialScales() const;
+
 	/**
 	* Resets the skeleton to the initial pose.
 	*/
 	void resetToInitialPose();
 
+	/**
+	* Recomputes cached world transformations of all bones
+	* which are out of date, in a single pass over the hierarchy.
+	*
+	* @remark World transformations are also updated on demand
+	* by Bone::getWorldPosition etc. Calling this after posing
+	* the skeleton makes subsequent world transformation queries
+	* read-only, so they can be issued from multiple threads.
+	*/
+	void updateWorldTransforms();
+
 	/**
 	* Get the bone with the specified semantic tag.
 	*
@@ -370,12 +430,49 @@ public:
 	void _removeBoneTagsFromBone( unsigned short boneId );
 	void _removeAllBoneTags();
 
+	/**
+	* Marks the compiled skeleton topology as out of date.
+	* Called from Bone class when the hierarchy or initial pose changes.
+	*/
+	void _invalidateTopology() { mTopologyDirty = true; _updateVersion(); }
+
+	/**
+	* Gets the skeleton version stamp, which changes whenever bones,
+	* bone tags or IK solvers are added, removed or modified.
+	* Version stamps are unique across all skeletons, so data derived
+	* from a skeleton can be validated by remembering its stamp.
+	*/
+	unsigned int _getVersion() const;
+
+	/**
+	* Compiles the skeleton topology, if it is out of date.
+	*/
+	void _compileTopology() const;
+
 private:
 
 	std::string mName;
 	mutable Bone* mRoot;
 	std::map<unsigned short, Bone*> mBonesById;
 	std::map<std::string, Bone*> mBonesByName;
+
+	void _updateVersion();
+
+	unsigned int mVersion;
+	// skeletons may be modified from parallel character updates
+#if zhMultiThreading_Enabled
+	static boost::atomic<unsigned int> msLastVersion;
+#else
+	static unsigned int msLastVersion;
+#endif
+
+	// compiled topology
+	mutable bool mTopologyDirty;
+	mutable std::vector<Bone*> mBonesByIndex;
+	mutable std::vector<unsigned int> mParentIndices;
+	mutable std::vector<Vector3> mInitPositions;
+	mutable std::vector<Quat> mInitOrientations;
+	mutable std::vector<Vector3> mInitScales;
 	std::map<BoneTag, Bone*> mBonesByTag;
 	std::map<unsigned short, IKSolver*> mIKSolversById;
 	std::map<std::string, IKSolver*> mIKSolversByName;
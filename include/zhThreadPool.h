@@ -0,0 +1,124 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#ifndef __zhThreadPool_h__
+#define __zhThreadPool_h__
+
+#include "zhPrereq.h"
+#include "zhFunctor.h"
+
+#if zhMultiThreading_Enabled
+#include <deque>
+#endif
+
+namespace zh
+{
+
+/**
+* @brief Work-stealing pool of worker threads.
+*
+* The pool runs batches of independent tasks. Each batch is split
+* into contiguous ranges, one per worker, and workers which run out of
+* tasks steal from the others. Tasks must not depend on each other or on
+* the order of execution, so results are the same regardless of
+* the number of workers.
+*
+* If multi-threading is disabled (see zhMultiThreading_Enabled),
+* all tasks are run in order on the calling thread.
+*/
+class zhDeclSpec ThreadPool
+{
+
+public:
+
+	typedef Functor1<void, unsigned int> Task; ///< Task functor, called with the task index.
+
+	/**
+	* Constructor.
+	*
+	* @param numWorkers Number of threads running tasks, including
+	* the calling thread. 0 or 1 means all tasks run on the calling thread.
+	*/
+	ThreadPool( unsigned int numWorkers = 1 );
+
+	/**
+	* Destructor.
+	*/
+	~ThreadPool();
+
+	/**
+	* Gets the number of threads running tasks, including the calling thread.
+	*/
+	unsigned int getNumWorkers() const;
+
+	/**
+	* Sets the number of threads running tasks, including the calling thread.
+	*
+	* @remark This must not be called while a batch is running.
+	*/
+	void setNumWorkers( unsigned int numWorkers );
+
+	/**
+	* Runs a batch of tasks and returns when all of them have finished.
+	*
+	* @param numTasks Number of tasks.
+	* @param task Task functor, called once for each task index
+	* in range [0, numTasks).
+	*/
+	void run( unsigned int numTasks, Task& task );
+
+private:
+
+#if zhMultiThreading_Enabled
+
+	struct WorkQueue
+	{
+		boost::mutex mMtx;
+		std::deque<unsigned int> mTasks;
+	};
+
+	void _startWorkers( unsigned int numWorkers );
+	void _stopWorkers();
+	void _workerLoop( unsigned int workerIndex );
+	bool _getTask( unsigned int workerIndex, unsigned int& taskIndex );
+	void _runTasks( unsigned int workerIndex );
+
+	std::vector<boost::thread*> mThreads;
+	std::vector<WorkQueue*> mQueues; ///< Task queues, one per worker (0 is the calling thread).
+
+	boost::mutex mMtx;
+	boost::condition_variable mBatchStarted;
+	boost::condition_variable mBatchFinished;
+	Task* mTask;
+	unsigned int mBatchId;
+	unsigned int mNumPending;
+	bool mStop;
+
+#endif
+
+	unsigned int mNumWorkers;
+
+};
+
+}
+
+#endif // __zhThreadPool_h__
@@ -26,6 +26,8 @@ SOFTWARE.
 #include "zhPrereq.h"
 #include "zhString.h"
 
+#define zhVector_InlineSize 16
+
 namespace zh
 {
 
@@ -34,6 +36,11 @@ class Matrix;
 /**
 * @brief Vector class, representing an N-dimensional vector
 * or point in N-dimensional space.
+*
+* Vectors of up to zhVector_InlineSize elements are stored inline,
+* so they can be created and copied without touching the heap.
+* Larger vectors are allocated on the heap, and their storage
+* is reused when a vector of the same or smaller size is assigned.
 */
 class zhDeclSpec Vector
 {
@@ -84,12 +91,14 @@ public:
 	Vector sub( const Vector& v ) const; ///< Subtracts two vectors.
 	float dot( const Vector& v ) const; ///< Vector dot-product.
 
-	// TODO: overload sizeof here and in Matrix class?
-
 private:
 
+	void _resize( unsigned int n );
+
 	unsigned int mN; ///< Vector dimensionality.
+	unsigned int mCapacity; ///< Number of components that fit into the current storage.
 	float* mV; ///< Vector components.
+	float mBuffer[zhVector_InlineSize]; ///< Inline storage for small vectors.
 
 };
 
@@ -22,14 +22,16 @@ SOFTWARE.
 
 #include "zhAnimation.h"
 #include "zhSkeleton.h"
+#include "zhPose.h"
 
 namespace zh
 {
 
-const std::set<unsigned short> Animation::EmptyBoneMask;
+const BoneMask Animation::EmptyBoneMask;
 
 Animation::Animation( unsigned short id, const std::string& name, AnimationSetPtr animSet )
-: mId(id), mName(name), mAnimSet(animSet), mInterpMethod(KFInterp_Spline), mFrameRate(60)
+: mId(id), mName(name), mAnimSet(animSet), mInterpMethod(KFInterp_Spline), mFrameRate(60),
+mMoverCurveKFVersion(0)
 {
 	zhAssert( animSet != NULL );
 
@@ -87,6 +89,9 @@ void Animation::deleteBoneTrack( unsigned short boneId )
 	{
 		delete bti->second;
 		mBoneTracks.erase(bti);
+
+		if( boneId == mMoverCurve.getBoneId() )
+			mMoverCurve.clear();
 	}
 }
 
@@ -97,6 +102,7 @@ void Animation::deleteAllBoneTracks()
 		delete bti->second;
 
 	mBoneTracks.clear();
+	mMoverCurve.clear();
 }
 
 bool Animation::hasBoneTrack( unsigned short boneId ) const
@@ -137,13 +143,48 @@ KFInterpolationMethod Animation::getKFInterpolationMethod() const
 void Animation::setKFInterpolationMethod( KFInterpolationMethod interpMethod )
 {
 	mInterpMethod = interpMethod;
+	buildInterpSplines();
+}
 
+void Animation::buildInterpSplines()
+{
 	if( mInterpMethod == KFInterp_Spline )
 	{
 		BoneTrackIterator bti = getBoneTrackIterator();
 		while( !bti.end() )
-			bti.next()->_buildInterpSplines();
+		{
+			BoneAnimationTrack* bat = bti.next();
+			if( !bat->_hasInterpSplines() )
+				bat->_buildInterpSplines();
+		}
 	}
+
+	// mover curve is sampled from the interpolated root track
+	buildMoverCurve();
+}
+
+void Animation::buildMoverCurve()
+{
+	mMoverCurve.clear();
+
+	BoneAnimationTrack* root_tr = getBoneTrack(0);
+	if( root_tr == NULL || root_tr->getNumKeyFrames() <= 0 )
+		return;
+
+	mMoverCurve.build( root_tr, getLength(), mFrameRate > 0 ? (float)mFrameRate : 60.f );
+	mMoverCurveKFVersion = root_tr->_getKeyFrameVersion();
+}
+
+const MoverCurve* Animation::getMoverCurve() const
+{
+	if( mMoverCurve.isEmpty() )
+		return NULL;
+
+	BoneAnimationTrack* root_tr = getBoneTrack(0);
+	if( root_tr == NULL || root_tr->_getKeyFrameVersion() != mMoverCurveKFVersion )
+		return NULL;
+
+	return &mMoverCurve;
 }
 
 float Animation::getLength() const
@@ -171,7 +212,7 @@ void Animation::setFrameRate( int frameRate )
 }
 
 void Animation::apply( Skeleton* skel, float time, float weight, float scale,
-					  const std::set<unsigned short> boneMask ) const
+					  const BoneMask& boneMask, KeyFrameCursor* cursor ) const
 {
 	zhAssert( skel != NULL );
 
@@ -180,8 +221,39 @@ void Animation::apply( Skeleton* skel, float time, float weight, float scale,
 	while( !bti.end() )
 	{
 		BoneAnimationTrack* bat = bti.next();
-		if( boneMask.count( bat->getBoneId() ) <= 0 )
-			bat->apply( skel, time, weight, scale );
+		if( !boneMask.isMasked( bat->getBoneId() ) )
+			bat->apply( skel, time, weight, scale, cursor );
+	}
+}
+
+void Animation::apply( Skeleton* skel, float time, float weight, float scale,
+					  const std::set<unsigned short>& boneMask, KeyFrameCursor* cursor ) const
+{
+	apply( skel, time, weight, scale, BoneMask(boneMask), cursor );
+}
+
+void Animation::sample( float time, Pose& pose, const BoneMask& boneMask,
+					   KeyFrameCursor* cursor ) const
+{
+	Vector3 trans, scal;
+	Quat rot;
+
+	BoneTrackConstIterator bti = getBoneTrackConstIterator();
+	while( !bti.end() )
+	{
+		BoneAnimationTrack* bat = bti.next();
+		unsigned short bone_id = bat->getBoneId();
+		if( boneMask.isMasked(bone_id) )
+			continue;
+
+		unsigned int bi = pose.getBoneIndex(bone_id);
+		if( bi == UINT_MAX )
+			continue;
+
+		bat->getInterpolatedTransform( time, trans, rot, scal, cursor );
+		pose.setTranslation( bi, trans );
+		pose.setRotation( bi, rot );
+		pose.setScale( bi, scal );
 	}
 }
 
@@ -194,12 +266,9 @@ void Animation::computeAnimationBounds( float& minX, float& maxX, float& minY, f
 
 	minX = minY = minZ = FLT_MAX;
 	maxX = maxY = maxZ = -FLT_MAX;
-	AnimationTrack::KeyFrameConstIterator kfi = root_tr->getKeyFrameConstIterator();
-	while( kfi.hasMore() )
+	for( unsigned int kfi = 0; kfi < root_tr->getNumKeyFrames(); ++kfi )
 	{
-		TransformKeyFrame* tkf = static_cast<TransformKeyFrame*>(kfi.next());
-
-		Vector3 trans = tkf->getTranslation();
+		const Vector3& trans = root_tr->getKeyFrameTranslation(kfi);
 		if( trans.x < minX )
 			minX = trans.x;
 		if( trans.x > maxX )
@@ -247,6 +316,7 @@ size_t Animation::_calcMemoryUsage() const
 		mem_usage += ( bti.next()->getNumKeyFrames() *
 			( sizeof(float) + 2 * sizeof(Vector3) + sizeof(Quat) ) );
 	}
+	mem_usage += mMoverCurve.getNumSamples() * ( sizeof(Vector3) + sizeof(Quat) );
 
 	// Compute memory usage from annotations:
 
@@ -281,11 +351,8 @@ void Animation::_clone( Animation* clonePtr ) const
 
 		for( unsigned int kfi = 0; kfi < bat->getNumKeyFrames(); ++kfi )
 		{
-			TransformKeyFrame* kf = ( TransformKeyFrame* )bat->getKeyFrame(kfi);
-			TransformKeyFrame* ckf = ( TransformKeyFrame* )cbat->createKeyFrame( kf->getTime() );
-			ckf->setTranslation( kf->getTranslation() );
-			ckf->setRotation( kf->getRotation() );
-			ckf->setScale( kf->getScale() );
+			cbat->createTransformKeyFrame( bat->getKeyFrameTime(kfi), bat->getKeyFrameTranslation(kfi),
+				bat->getKeyFrameRotation(kfi), bat->getKeyFrameScale(kfi) );
 		}
 	}
 
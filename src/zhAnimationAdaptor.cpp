@@ -28,7 +28,8 @@ namespace zh
 {
 
 AnimationAdaptor::AnimationAdaptor( Skeleton* origSkel, AnimationNode* animNode ) :
-mOrigSkel(origSkel), mAnimNode(animNode), mPredWeight(0.f), mEnvSens(20.f)
+mOrigSkel(origSkel), mAnimNode(animNode), mPredWeight(0.f), mEnvSens(20.f),
+mRetargetSkel(NULL), mOrigSkelVersion(0), mTargetSkelVersion(0)
 {
 	zhAssert( animNode != NULL );
 
@@ -77,14 +78,16 @@ void AnimationAdaptor::adapt( Skeleton* targetSkel )
 {
 	zhAssert( targetSkel != NULL );
 
+	if( !_isRetargetMapValid(targetSkel) )
+		_buildRetargetMap(targetSkel);
+
 	// Set initial pose estimate
-	Skeleton::BoneIterator bone_i = mOrigSkel->getBoneIterator();
-	while( bone_i.hasMore() )
+	for( std::vector<BoneMapping>::const_iterator bmi = mBoneMappings.begin();
+		bmi != mBoneMappings.end(); ++bmi )
 	{
-		Bone* orig_bone = bone_i.next();
-		Bone* trg_bone = targetSkel->getBone( orig_bone->getName() );
-		if( trg_bone == NULL ) continue;
-		if( trg_bone == targetSkel->getRoot() )
+		Bone* orig_bone = mOrigSkel->getBoneByIndex( bmi->mOrigIndex );
+		Bone* trg_bone = targetSkel->getBoneByIndex( bmi->mTargetIndex );
+		if( bmi->mRoot )
 			trg_bone->setPosition( orig_bone->getPosition() );
 		trg_bone->setOrientation( orig_bone->getOrientation() );
 	}
@@ -93,8 +96,31 @@ void AnimationAdaptor::adapt( Skeleton* targetSkel )
 	targetSkel->solveIK();
 }
 
-void AnimationAdaptor::_computeIKGoals( Skeleton* targetSkel ) const
+void AnimationAdaptor::_buildRetargetMap( Skeleton* targetSkel )
 {
+	zhAssert( targetSkel != NULL );
+
+	mBoneMappings.clear();
+	mEndEffMappings.clear();
+	mGoalSolvers.clear();
+
+	// Match bones by name
+	Bone* trg_root = targetSkel->getRoot();
+	Skeleton::BoneConstIterator bone_i = mOrigSkel->getBoneConstIterator();
+	while( bone_i.hasMore() )
+	{
+		Bone* orig_bone = bone_i.next();
+		Bone* trg_bone = targetSkel->getBone( orig_bone->getName() );
+		if( trg_bone == NULL ) continue;
+
+		BoneMapping bm;
+		bm.mOrigIndex = orig_bone->getIndex();
+		bm.mTargetIndex = trg_bone->getIndex();
+		bm.mRoot = trg_bone == trg_root;
+		mBoneMappings.push_back(bm);
+	}
+
+	// Resolve end-effector tags
 	for( std::vector<BoneTag>::const_iterator eei = mEndEffectors.begin();
 			eei != mEndEffectors.end(); ++eei )
 	{
@@ -102,15 +128,49 @@ void AnimationAdaptor::_computeIKGoals( Skeleton* targetSkel ) const
 		if( !mOrigSkel->hasBoneWithTag(eetag) || !targetSkel->hasBoneWithTag(eetag) )
 			continue;
 
-		Bone* orig_ee = mOrigSkel->getBoneByTag(eetag);
-		float weight = _computeIKGoalWeight(orig_ee);
-		IKGoal goal( targetSkel->getBoneByTag(eetag)->getId(),
-			orig_ee->getWorldPosition(), weight );
+		EndEffectorMapping eem;
+		eem.mOrigIndex = mOrigSkel->getBoneByTag(eetag)->getIndex();
+		eem.mTargetBoneId = targetSkel->getBoneByTag(eetag)->getId();
+		mEndEffMappings.push_back(eem);
+	}
+
+	// Route goals to solvers
+	// (root and posture solvers consume goals for all end-effectors,
+	// so each solver is given every goal, as before)
+	Skeleton::IKSolverIterator solver_i = targetSkel->getIKSolverIterator();
+	while( solver_i.hasMore() )
+		mGoalSolvers.push_back( solver_i.next() );
 
-		Skeleton::IKSolverIterator solver_i = targetSkel->getIKSolverIterator();
-		while( solver_i.hasMore() )
-			solver_i.next()->setGoal(goal);
+	mGoals.reserve( mEndEffMappings.size() );
+
+	mRetargetSkel = targetSkel;
+	mOrigSkelVersion = mOrigSkel->_getVersion();
+	mTargetSkelVersion = targetSkel->_getVersion();
+}
+
+bool AnimationAdaptor::_isRetargetMapValid( Skeleton* targetSkel ) const
+{
+	return mRetargetSkel == targetSkel &&
+		mOrigSkelVersion == mOrigSkel->_getVersion() &&
+		mTargetSkelVersion == targetSkel->_getVersion();
+}
+
+void AnimationAdaptor::_computeIKGoals( Skeleton* targetSkel ) const
+{
+	mGoals.clear();
+	for( std::vector<EndEffectorMapping>::const_iterator eemi = mEndEffMappings.begin();
+			eemi != mEndEffMappings.end(); ++eemi )
+	{
+		Bone* orig_ee = mOrigSkel->getBoneByIndex( eemi->mOrigIndex );
+		float weight = _computeIKGoalWeight(orig_ee);
+		mGoals.push_back( IKGoal( eemi->mTargetBoneId, orig_ee->getWorldPosition(), weight ) );
 	}
+
+	for( std::vector<IKSolver*>::const_iterator solver_i = mGoalSolvers.begin();
+		solver_i != mGoalSolvers.end(); ++solver_i )
+		for( std::vector<IKGoal>::const_iterator goal_i = mGoals.begin();
+			goal_i != mGoals.end(); ++goal_i )
+			(*solver_i)->setGoal(*goal_i);
 }
 
 float AnimationAdaptor::_computeIKGoalWeight(Bone* endEff) const
@@ -26,7 +26,7 @@ namespace zh
 {
 
 AnimationAnnotation::AnimationAnnotation( float startTime, float endTime )
-: mStartTime(startTime), mEndTime(endTime)
+: mStartTime(startTime), mEndTime(endTime), mContainer(NULL)
 {
 }
 
@@ -41,8 +41,14 @@ float AnimationAnnotation::getStartTime() const
 
 void AnimationAnnotation::setStartTime( float time )
 {
+	if( mContainer != NULL )
+		mContainer->_removeFromIndex(this);
+
 	mStartTime = time;
 	if( mEndTime < mStartTime ) mEndTime = mStartTime;
+
+	if( mContainer != NULL )
+		mContainer->_addToIndex(this);
 }
 
 float AnimationAnnotation::getEndTime() const
@@ -52,8 +58,14 @@ float AnimationAnnotation::getEndTime() const
 
 void AnimationAnnotation::setEndTime( float time )
 {
+	if( mContainer != NULL )
+		mContainer->_removeFromIndex(this);
+
 	mEndTime = time;
 	if( mEndTime < mStartTime ) mStartTime = mEndTime;
+
+	if( mContainer != NULL )
+		mContainer->_addToIndex(this);
 }
 
 void AnimationAnnotation::_clone( AnimationAnnotation* clonePtr ) const
@@ -64,6 +76,16 @@ void AnimationAnnotation::_clone( AnimationAnnotation* clonePtr ) const
 	clonePtr->mEndTime = mEndTime;*/
 }
 
+AnimationAnnotationContainer* AnimationAnnotation::_getContainer() const
+{
+	return mContainer;
+}
+
+void AnimationAnnotation::_setContainer( AnimationAnnotationContainer* container )
+{
+	mContainer = container;
+}
+
 TransitionAnnotation::TransitionAnnotation( float startTime, float endTime )
 : AnimationAnnotation( startTime, endTime ), mTargetSetId(0), mTargetId(0), mTargetTime(0)
 {
@@ -276,6 +298,7 @@ void SimEventAnnotation::_clone( AnimationAnnotation* clonePtr ) const
 }
 
 AnimationAnnotationContainer::AnimationAnnotationContainer()
+: mIndexVersion(1)
 {
 }
 
@@ -310,6 +333,9 @@ AnimationAnnotation* AnimationAnnotationContainer::createAnnotation( float start
 		}
 	}
 
+	annot->_setContainer(this);
+	_addToIndex(annot);
+
 	return annot;
 }
 
@@ -317,6 +343,7 @@ void AnimationAnnotationContainer::deleteAnnotation( unsigned int index )
 {
 	zhAssert( index < getNumAnnotations() );
 
+	_removeFromIndex( mAnnots[index] );
 	delete mAnnots[index];
 	mAnnots.erase( mAnnots.begin() + index );
 }
@@ -327,6 +354,12 @@ void AnimationAnnotationContainer::deleteAllAnnotations()
 		delete mAnnots[ani];
 
 	mAnnots.clear();
+
+	mStartTimes.clear();
+	mAnnotsByStart.clear();
+	mEndTimes.clear();
+	mAnnotsByEnd.clear();
+	++mIndexVersion;
 }
 
 AnimationAnnotation* AnimationAnnotationContainer::getAnnotation( unsigned int index ) const
@@ -353,69 +386,78 @@ AnimationAnnotationContainer::AnnotationConstIterator AnimationAnnotationContain
 
 unsigned int AnimationAnnotationContainer::getActiveAnnotations( float time, std::vector<AnimationAnnotation*>& annots ) const
 {
-	// TODO: this should be optimized
-
 	annots.clear();
 
-	for( unsigned int ani = 0; ani < mAnnots.size(); ++ani )
+	for( unsigned int ani = 0; ani < mAnnotsByStart.size(); ++ani )
 	{
-		AnimationAnnotation* an = mAnnots[ani];
-		float st = an->getStartTime(),
-			et = an->getEndTime();
+		if( mStartTimes[ani] > time )
+			break;
 
-		if( time >= st && time <= et )
+		AnimationAnnotation* an = mAnnotsByStart[ani];
+		if( time <= an->getEndTime() )
 			annots.push_back(an);
-
-		if( st > time )
-			break;
 	}
 
 	return annots.size();
 }
 
 unsigned int AnimationAnnotationContainer::getActiveAnnotations( float prevTime, float time,
-																std::vector<AnimationAnnotation*>& annots, bool countPassed ) const
+																std::vector<AnimationAnnotation*>& annots, bool countPassed,
+																AnnotationCursor* cursor ) const
 {
-	// TODO: this should be optimized
-
 	annots.clear();
 
-	for( unsigned int ani = 0; ani < mAnnots.size(); ++ani )
+	bool use_cursor = cursor != NULL && cursor->mContainer == this &&
+		cursor->mIndexVersion == mIndexVersion;
+
+	// annotations that start in (prevTime, time]
+	unsigned int ani = _findIndexPosition( mStartTimes, prevTime, true,
+		use_cursor ? cursor->mStartPos : 0 );
+	for( ; ani < mStartTimes.size() && mStartTimes[ani] <= time; ++ani )
 	{
-		AnimationAnnotation* an = mAnnots[ani];
-		float st = an->getStartTime(),
-			et = an->getEndTime();
+		AnimationAnnotation* an = mAnnotsByStart[ani];
 
-		if( prevTime < st && time >= st && time <= et ||
-			countPassed && prevTime < st && time > et )
+		if( countPassed || time <= an->getEndTime() )
 			annots.push_back(an);
+	}
 
-		if( prevTime > et )
-			break;
+	if( cursor != NULL )
+	{
+		cursor->mContainer = this;
+		cursor->mIndexVersion = mIndexVersion;
+		cursor->mStartPos = time >= prevTime ? ani :
+			_findIndexPosition( mStartTimes, time, true, ani );
 	}
 
 	return annots.size();
 }
 
 unsigned int AnimationAnnotationContainer::getFinishedAnnotations( float prevTime, float time,
-																  std::vector<AnimationAnnotation*>& annots, bool countPassed ) const
+																  std::vector<AnimationAnnotation*>& annots, bool countPassed,
+																  AnnotationCursor* cursor ) const
 {
-	// TODO: this should be optimized
-
 	annots.clear();
 
-	for( unsigned int ani = 0; ani < mAnnots.size(); ++ani )
+	bool use_cursor = cursor != NULL && cursor->mContainer == this &&
+		cursor->mIndexVersion == mIndexVersion;
+
+	// annotations that end in [prevTime, time)
+	unsigned int ani = _findIndexPosition( mEndTimes, prevTime, false,
+		use_cursor ? cursor->mEndPos : 0 );
+	for( ; ani < mEndTimes.size() && mEndTimes[ani] < time; ++ani )
 	{
-		AnimationAnnotation* an = mAnnots[ani];
-		float st = an->getStartTime(),
-			et = an->getEndTime();
+		AnimationAnnotation* an = mAnnotsByEnd[ani];
 
-		if( prevTime >= st && prevTime <= et && time > et ||
-			countPassed && prevTime < st && time > et )
+		if( countPassed || an->getStartTime() <= prevTime )
 			annots.push_back(an);
+	}
 
-		if( prevTime > et )
-			break;
+	if( cursor != NULL )
+	{
+		cursor->mContainer = this;
+		cursor->mIndexVersion = mIndexVersion;
+		cursor->mEndPos = time >= prevTime ? ani :
+			_findIndexPosition( mEndTimes, time, false, ani );
 	}
 
 	return annots.size();
@@ -433,6 +475,78 @@ void AnimationAnnotationContainer::_clone( AnimationAnnotationContainer* clonePt
 	}
 }
 
+void AnimationAnnotationContainer::_removeFromIndex( AnimationAnnotation* annot )
+{
+	zhAssert( annot != NULL );
+
+	std::vector<float>::iterator ti = std::lower_bound( mStartTimes.begin(), mStartTimes.end(), annot->getStartTime() );
+	for( unsigned int ani = ti - mStartTimes.begin(); ani < mAnnotsByStart.size(); ++ani )
+	{
+		if( mAnnotsByStart[ani] == annot )
+		{
+			mStartTimes.erase( mStartTimes.begin() + ani );
+			mAnnotsByStart.erase( mAnnotsByStart.begin() + ani );
+			break;
+		}
+	}
+
+	ti = std::lower_bound( mEndTimes.begin(), mEndTimes.end(), annot->getEndTime() );
+	for( unsigned int ani = ti - mEndTimes.begin(); ani < mAnnotsByEnd.size(); ++ani )
+	{
+		if( mAnnotsByEnd[ani] == annot )
+		{
+			mEndTimes.erase( mEndTimes.begin() + ani );
+			mAnnotsByEnd.erase( mAnnotsByEnd.begin() + ani );
+			break;
+		}
+	}
+
+	++mIndexVersion;
+}
+
+void AnimationAnnotationContainer::_addToIndex( AnimationAnnotation* annot )
+{
+	zhAssert( annot != NULL );
+
+	unsigned int ani = std::upper_bound( mStartTimes.begin(), mStartTimes.end(), annot->getStartTime() ) -
+		mStartTimes.begin();
+	mStartTimes.insert( mStartTimes.begin() + ani, annot->getStartTime() );
+	mAnnotsByStart.insert( mAnnotsByStart.begin() + ani, annot );
+
+	ani = std::upper_bound( mEndTimes.begin(), mEndTimes.end(), annot->getEndTime() ) -
+		mEndTimes.begin();
+	mEndTimes.insert( mEndTimes.begin() + ani, annot->getEndTime() );
+	mAnnotsByEnd.insert( mAnnotsByEnd.begin() + ani, annot );
+
+	++mIndexVersion;
+}
+
+unsigned int AnimationAnnotationContainer::_findIndexPosition( const std::vector<float>& times, float time,
+															  bool after, unsigned int hint ) const
+{
+	// max. number of positions we step over before giving up on the hint
+	static const unsigned int max_steps = 4;
+
+	unsigned int pos = hint < times.size() ? hint : times.size();
+	for( unsigned int si = 0; si <= max_steps; ++si )
+	{
+		if( pos > 0 && ( after ? times[pos-1] > time : times[pos-1] >= time ) )
+			// step back
+			--pos;
+		else if( pos < times.size() && ( after ? times[pos] <= time : times[pos] < time ) )
+			// step forward
+			++pos;
+		else
+			return pos;
+	}
+
+	// too far from the hint, look it up
+	if(after)
+		return std::upper_bound( times.begin(), times.end(), time ) - times.begin();
+
+	return std::lower_bound( times.begin(), times.end(), time ) - times.begin();
+}
+
 AnimationAnnotation* TransitionAnnotationContainer::_createAnnotation( float startTime, float endTime )
 {
 	return new TransitionAnnotation( startTime, endTime );
@@ -45,6 +45,46 @@ bool AnimationBlendNode::isLeaf() const
 	return false;
 }
 
+void AnimationBlendNode::addChild( AnimationNode* node )
+{
+	unsigned int num_children = mChildren.size();
+	AnimationNode::addChild(node);
+	if( mChildren.size() == num_children )
+		// node is already a child
+		return;
+
+	// insert a zero weight into the new child's slot
+	unsigned int slot_i = std::find( mChildren.begin(), mChildren.end(), node ) - mChildren.begin();
+	Vector weights( mChildren.size() );
+	for( unsigned int ci = 0; ci < mChildren.size(); ++ci )
+	{
+		unsigned int prev_ci = ci < slot_i ? ci : ci - 1;
+		weights[ci] = ci != slot_i && prev_ci < mWeights.size() ? mWeights[prev_ci] : 0;
+	}
+	mWeights = weights;
+
+	// shift slots of subsequent children
+	for( std::map<unsigned short, unsigned int>::iterator mi = mChildrenToBaseAnims.begin();
+		mi != mChildrenToBaseAnims.end(); ++mi )
+	{
+		if( mi->second >= slot_i )
+			++mi->second;
+	}
+	mChildrenToBaseAnims[ node->getId() ] = slot_i;
+
+	AnimationSpace* anim_space = getAnimationSpace();
+	if( anim_space != NULL && anim_space->getNumBaseAnimations() == getNumChildren() )
+		_mapBaseAnimations();
+}
+
+void AnimationBlendNode::removeAllChildren()
+{
+	AnimationNode::removeAllChildren();
+
+	mChildrenToBaseAnims.clear();
+	mWeights = Vector();
+}
+
 void AnimationBlendNode::setPlaying( bool playing )
 {
 	AnimationNode::setPlaying(playing);
@@ -111,12 +151,8 @@ float AnimationBlendNode::getPlayLength() const
 {
 	float play_length = 0;
 
-	ChildConstIterator ci = getChildConstIterator();
-	while( !ci.end() )
-	{
-		AnimationNode* cn = ci.next();
-		play_length += cn->getPlayLength() * getWeight( cn->getId() );
-	}
+	for( unsigned int banim_i = 0; banim_i < mChildren.size(); ++banim_i )
+		play_length += mChildren[banim_i]->getPlayLength() * mWeights[banim_i];
 
 	return play_length;
 }
@@ -155,20 +191,15 @@ void AnimationBlendNode::setOrigin( const Skeleton::Situation& origin )
 		float t;
 		_getTWCurvePosition( mTWCurveTime, cpi, t );
 		const CatmullRomSpline<Vector>& align_curve = anim_space->getAlignmentCurve();
-		Vector child_align = align_curve.getPoint( cpi, t );
+		align_curve.getPoint( cpi, t, mAlignCurvePoint );
 
-		ChildConstIterator child_i = getChildConstIterator();
-		while( !child_i.end() )
+		for( unsigned int banim_i = 0; banim_i < mChildren.size(); ++banim_i )
 		{
-			AnimationNode* child = child_i.next();
-
-			// get base anim. index
-			unsigned short child_id = child->getId();
-			unsigned int banim_i = mChildrenToBaseAnims[child_id];
+			AnimationNode* child = mChildren[banim_i];
 
 			// compute origin
 			Skeleton::Situation child_orig = mOrigin;
-			/*Skeleton::Situation child_orig( child_align[3*banim_i], child_align[3*banim_i+1], child_align[3*banim_i+2] );
+			/*Skeleton::Situation child_orig( mAlignCurvePoint[3*banim_i], mAlignCurvePoint[3*banim_i+1], mAlignCurvePoint[3*banim_i+2] );
 			child_orig.transform(origin);*/
 
 			child->setOrigin(child_orig);
@@ -340,38 +371,7 @@ void AnimationBlendNode::setAnimationSpace( AnimationSetPtr animSet, unsigned sh
 	zhAssert( anim_space != NULL );
 	zhAssert( anim_space->getNumBaseAnimations() == getNumChildren() );
 
-	// iterate through all child nodes and determine
-	// which base anim. in the animation space maps to which child
-	mChildrenToBaseAnims.clear();
-	for( unsigned int banim_i = 0; banim_i < anim_space->getNumBaseAnimations(); ++banim_i )
-	{
-		Animation* banim = anim_space->getBaseAnimation(banim_i);
-
-		AnimationNode::ChildConstIterator child_i = getChildConstIterator();
-		while( child_i.hasMore() )
-		{
-			AnimationNode* child = child_i.next();
-
-			if( child->isClass( AnimationSampleNode::ClassId() ) )
-			{
-				AnimationSampleNode* snode = static_cast<AnimationSampleNode*>(child);
-				if( snode->getAnimationId() == banim->getId() )
-				{
-					mChildrenToBaseAnims[ child->getId() ] = banim_i;
-					break;
-				}
-			}
-			else if( child->isClass( AnimationBlendNode::ClassId() ) )
-			{
-				AnimationBlendNode* bnode = static_cast<AnimationBlendNode*>(child);
-				if( bnode->getAnimationSpaceId() == banim->getId() )
-				{
-					mChildrenToBaseAnims[ child->getId() ] = banim_i;
-					break;
-				}
-			}
-		}
-	}
+	_mapBaseAnimations();
 
 	// init. blend weights and param. values
 	mWeights = Vector( getNumChildren() );
@@ -392,6 +392,14 @@ void AnimationBlendNode::setUseBlendCurves( bool useBlendCurves )
 	mUseBlendCurves = useBlendCurves;
 }
 
+unsigned int AnimationBlendNode::_getBaseAnimationIndex( unsigned short nodeId ) const
+{
+	std::map<unsigned short, unsigned int>::const_iterator ci = mChildrenToBaseAnims.find(nodeId);
+	zhAssert( ci != mChildrenToBaseAnims.end() );
+
+	return ci->second;
+}
+
 Skeleton::Situation AnimationBlendNode::_sampleMover() const
 {
 	// TODO: this is reasonably accurate only when not using blend curves, but whatever
@@ -401,18 +409,14 @@ Skeleton::Situation AnimationBlendNode::_sampleMover() const
 	float total_weight = 0;
 
 	// blend child movers
-	ChildConstIterator child_i = getChildConstIterator();
-	while( !child_i.end() )
+	for( unsigned int banim_i = 0; banim_i < mChildren.size(); ++banim_i )
 	{
-		AnimationNode* child = child_i.next();
-		unsigned short child_id = child->getId();
-		unsigned int banim_i = mChildrenToBaseAnims.find(child_id)->second;
 		float weight = mWeights[banim_i];
 
-		if( zhEqualf( mWeights[banim_i], 0 ) )
+		if( zhEqualf( weight, 0 ) )
 			continue;
 
-		Skeleton::Situation child_mv = child->_sampleMover();
+		Skeleton::Situation child_mv = mChildren[banim_i]->_sampleMover();
 		mv = Skeleton::Situation(
 			mv.getPosition() + child_mv.getPosition() * weight,
 			mv.getOrientation().slerp( child_mv.getOrientation(), weight/( weight + total_weight ) )
@@ -441,7 +445,10 @@ void AnimationBlendNode::_clone( AnimationNode* clonePtr, bool shareData ) const
 	clone->mOrigin = mOrigin;
 
 	clone->setAnimationSpace( mAnimSet, mAnimSpaceId );
-	clone->mChildrenToBaseAnims = mChildrenToBaseAnims; // TODO: this may not initialize correctly because children of this blender may not be cloned yet
+	// children of this blender may not be cloned yet, so copy child order from the original
+	clone->mChildrenToBaseAnims = mChildrenToBaseAnims;
+	for( unsigned int banim_i = 0; banim_i < mChildren.size(); ++banim_i )
+		clone->mChildren[banim_i] = clone->getChild( mChildren[banim_i]->getId() );
 	if( getAnimationSpace()->hasParametrization() )
 		clone->setParams(mParams);
 	else
@@ -474,16 +481,15 @@ void AnimationBlendNode::_updateNode( float dt )
 		_getTWCurvePosition( u0, cpi0, t0 );
 		_getTWCurvePosition( mTWCurveTime, cpi, t );
 		// sample timewarp curve
-		Vector ctimes0 = tw_curve.getPoint( cpi0, t0 ),
-			ctimes = tw_curve.getPoint( cpi, t );
+		tw_curve.getPoint( cpi0, t0, mTWCurvePoint0 );
+		tw_curve.getPoint( cpi, t, mTWCurvePoint );
+		const Vector& ctimes0 = mTWCurvePoint0;
+		const Vector& ctimes = mTWCurvePoint;
 
 		// update child nodes		
-		ChildIterator child_i = getChildIterator();
-		while( !child_i.end() )
+		for( unsigned int banim_i = 0; banim_i < mChildren.size(); ++banim_i )
 		{
-			AnimationNode* child = child_i.next();
-			unsigned short child_id = child->getId();
-			unsigned int banim_i = mChildrenToBaseAnims[child_id];
+			AnimationNode* child = mChildren[banim_i];
 
 			if( zhEqualf( mWeights[banim_i], 0 ) )
 				continue;
@@ -504,12 +510,9 @@ void AnimationBlendNode::_updateNode( float dt )
 	else
 	{
 		// update child nodes
-		ChildIterator child_i = getChildIterator();
-		while( !child_i.end() )
+		for( unsigned int banim_i = 0; banim_i < mChildren.size(); ++banim_i )
 		{
-			AnimationNode* child = child_i.next();
-			unsigned short child_id = child->getId();
-			unsigned int banim_i = mChildrenToBaseAnims[child_id];
+			AnimationNode* child = mChildren[banim_i];
 
 			if( zhEqualf( mWeights[banim_i], 0 ) )
 				continue;
@@ -519,24 +522,40 @@ void AnimationBlendNode::_updateNode( float dt )
 	}
 }
 
-void AnimationBlendNode::_applyNode( float weight, const std::set<unsigned short>& boneMask ) const
+void AnimationBlendNode::_applyNode( float weight, const BoneMask& boneMask ) const
 {
+	// Count active child nodes
+	unsigned int num_active = 0;
+	float active_weight = 0;
+	for( unsigned int banim_i = 0; banim_i < mChildren.size(); ++banim_i )
+	{
+		float child_weight = mWeights[banim_i];
+
+		if( zhEqualf( child_weight, 0 ) )
+			continue;
+
+		++num_active;
+		active_weight = child_weight;
+	}
+
+	// Blend child poses, unless a single child is applied with full weight
+	bool blend = ( num_active > 1 || ( num_active == 1 && !zhEqualf( active_weight, 1 ) ) ) &&
+		_beginPoseBlend();
 
-	// Apply child nodes		
-	ChildConstIterator child_i = getChildConstIterator();
-	while( !child_i.end() )
+	// Apply child nodes
+	for( unsigned int banim_i = 0; banim_i < mChildren.size(); ++banim_i )
 	{
-		AnimationNode* child_node = child_i.next();
-		unsigned short child_id = child_node->getId();
-		unsigned int banim_i = mChildrenToBaseAnims.find(child_id)->second;
 		float child_weight = mWeights[banim_i];
 
 		if( zhEqualf( child_weight, 0 ) )
 			continue;
 
-		child_node->apply( weight*child_weight, boneMask );
+		mChildren[banim_i]->apply( weight*child_weight, boneMask );
 	}
 
+	if(blend)
+		_endPoseBlend();
+
 	// Find active plant constraints
 	/*std::vector<AnimationAnnotation*> annots;
 	float t = getPlayTime();
@@ -802,6 +821,110 @@ void AnimationBlendNode::_blendAnnotations()
 	}
 }
 
+void AnimationBlendNode::_eraseChild( AnimationNode* node )
+{
+	std::vector<AnimationNode*>::iterator child_i = std::find( mChildren.begin(), mChildren.end(), node );
+	if( child_i == mChildren.end() )
+		return;
+
+	// remove the child's slot along with its weight
+	unsigned int slot_i = child_i - mChildren.begin();
+	mChildren.erase(child_i);
+	Vector weights = mChildren.empty() ? Vector() : Vector( mChildren.size() );
+	for( unsigned int ci = 0; ci < mChildren.size(); ++ci )
+	{
+		unsigned int prev_ci = ci < slot_i ? ci : ci + 1;
+		weights[ci] = prev_ci < mWeights.size() ? mWeights[prev_ci] : 0;
+	}
+	mWeights = weights;
+
+	// shift slots of subsequent children
+	mChildrenToBaseAnims.erase( node->getId() );
+	for( std::map<unsigned short, unsigned int>::iterator mi = mChildrenToBaseAnims.begin();
+		mi != mChildrenToBaseAnims.end(); ++mi )
+	{
+		if( mi->second > slot_i )
+			--mi->second;
+	}
+
+	AnimationSpace* anim_space = getAnimationSpace();
+	if( anim_space != NULL && anim_space->getNumBaseAnimations() == getNumChildren() )
+		_mapBaseAnimations();
+}
+
+void AnimationBlendNode::_mapBaseAnimations()
+{
+	AnimationSpace* anim_space = getAnimationSpace();
+	zhAssert( anim_space != NULL );
+
+	// iterate through all child nodes and determine
+	// which base anim. in the animation space maps to which child
+	mChildrenToBaseAnims.clear();
+	std::vector<AnimationNode*> children( std::max<size_t>( anim_space->getNumBaseAnimations(), mChildren.size() ),
+		(AnimationNode*)NULL );
+	for( unsigned int banim_i = 0; banim_i < anim_space->getNumBaseAnimations(); ++banim_i )
+	{
+		Animation* banim = anim_space->getBaseAnimation(banim_i);
+
+		AnimationNode::ChildConstIterator child_i = getChildConstIterator();
+		while( child_i.hasMore() )
+		{
+			AnimationNode* child = child_i.next();
+
+			if( child->isClass( AnimationSampleNode::ClassId() ) )
+			{
+				AnimationSampleNode* snode = static_cast<AnimationSampleNode*>(child);
+				if( snode->getAnimationId() == banim->getId() )
+				{
+					mChildrenToBaseAnims[ child->getId() ] = banim_i;
+					children[banim_i] = child;
+					break;
+				}
+			}
+			else if( child->isClass( AnimationBlendNode::ClassId() ) )
+			{
+				AnimationBlendNode* bnode = static_cast<AnimationBlendNode*>(child);
+				if( bnode->getAnimationSpaceId() == banim->getId() )
+				{
+					mChildrenToBaseAnims[ child->getId() ] = banim_i;
+					children[banim_i] = child;
+					break;
+				}
+			}
+		}
+	}
+
+	// reorder child nodes by base anim. index,
+	// children without a matching base anim. take up the remaining slots
+	unsigned int free_i = 0;
+	for( unsigned int ci = 0; ci < mChildren.size(); ++ci )
+	{
+		AnimationNode* child = mChildren[ci];
+		if( mChildrenToBaseAnims.count( child->getId() ) > 0 )
+			continue;
+
+		while( children[free_i] != NULL )
+			++free_i;
+		mChildrenToBaseAnims[ child->getId() ] = free_i;
+		children[free_i] = child;
+	}
+	while( !children.empty() && children.back() == NULL )
+		children.pop_back();
+
+	// weights follow their children to the new slots
+	Vector weights = children.empty() ? Vector() : Vector( children.size() );
+	for( unsigned int ci = 0; ci < mChildren.size(); ++ci )
+	{
+		unsigned int slot_i = mChildrenToBaseAnims[ mChildren[ci]->getId() ];
+		if( slot_i < weights.size() )
+			weights[slot_i] = ci < mWeights.size() ? mWeights[ci] : 0;
+	}
+	mWeights = weights;
+	mChildren = children;
+
+	mOwner->_invalidateProgram();
+}
+
 void AnimationBlendNode::_getTWCurvePosition( float u, unsigned int& cpi, float& t ) const
 {
 	cpi = (unsigned int)u;
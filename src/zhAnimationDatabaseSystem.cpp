@@ -47,7 +47,7 @@ namespace zh
 
 AnimationDatabaseSystem::AnimationDatabaseSystem()
 : mResampleFact(3), mWndLength(0.35f), mMinDist(0.05f), mMaxDistDiff(0.15f),
-mMinChainLength(0.25f), mMaxBridgeLength(1.f),
+mMinChainLength(0.25f), mMaxBridgeLength(1.f), mNumIndexThreads(1), mNumTransitionThreads(1),
 mMaxOverlap(0.8f),
 mMatchAnnots(true), mBuildBlendCurves(true), mKnotSpacing(3),
 mMaxExtrap(0.15f), mMinSampleDist(0.00001f)
@@ -263,6 +263,7 @@ AnimationSetPtr AnimationDatabaseSystem::initTrainPoses()
 			tkf1->setTranslation( tkf->getTranslation() );
 			tkf1->setRotation( tkf->getRotation() );
 		}
+		anim->buildInterpSplines();
 
 		// Add animation node to tree
 		AnimationTree* anim_tree = zhAnimationSystem->getAnimationTree();
@@ -363,7 +364,7 @@ AnimationIndexPtr AnimationDatabaseSystem::buildIndex( unsigned long id, const s
 
 	// build anim. index
 	anim_index->buildIndex( mResampleFact, mWndLength, mMinDist,
-		mMaxDistDiff, mMinChainLength, mMaxBridgeLength );
+		mMaxDistDiff, mMinChainLength, mMaxBridgeLength, mNumIndexThreads );
 
 	return anim_index;
 }
@@ -583,6 +584,7 @@ void AnimationDatabaseSystem::buildTransitions( Skeleton* skel, std::vector<Anim
 
 	// build transitions between each two anims
 	AnimationTransitionBuilder* ptb = new AnimationTransitionBuilder(skel);
+	ptb->setNumThreads(mNumTransitionThreads);
 	for( unsigned int anim_i1 = 0; anim_i1 < anims.size(); ++anim_i1 )
 	{
 		for( unsigned int anim_i2 = anim_i1; anim_i2 < anims.size(); ++anim_i2 )
@@ -600,6 +602,7 @@ unsigned int AnimationDatabaseSystem::buildTransitions( Skeleton* skel, Animatio
 	zhAssert( trgAnim != NULL );
 
 	AnimationTransitionBuilder* ptb = new AnimationTransitionBuilder(skel);
+	ptb->setNumThreads(mNumTransitionThreads);
 	unsigned int num_built = ptb->buildTransitions( srcAnim, trgAnim, mWndLength, mMinDist );
 	delete ptb;
 
@@ -613,6 +616,7 @@ unsigned int AnimationDatabaseSystem::buildTransitions( Skeleton* skel, Animatio
 	zhAssert( trgAnim != NULL );
 
 	AnimationTransitionBuilder* ptb = new AnimationTransitionBuilder(skel);
+	ptb->setNumThreads(mNumTransitionThreads);
 	unsigned int num_built = ptb->buildTransitions( srcAnim, trgAnim, mWndLength, mMinDist );
 	delete ptb;
 
@@ -626,6 +630,7 @@ unsigned int AnimationDatabaseSystem::buildTransitions( Skeleton* skel, Animatio
 	zhAssert( trgAnim != NULL );
 
 	AnimationTransitionBuilder* ptb = new AnimationTransitionBuilder(skel);
+	ptb->setNumThreads(mNumTransitionThreads);
 	unsigned int num_built = ptb->buildTransitions( srcAnim, trgAnim, mWndLength, mMinDist );
 	delete ptb;
 
@@ -639,6 +644,7 @@ unsigned int AnimationDatabaseSystem::buildTransitions( Skeleton* skel, Animatio
 	zhAssert( trgAnim != NULL );
 
 	AnimationTransitionBuilder* ptb = new AnimationTransitionBuilder(skel);
+	ptb->setNumThreads(mNumTransitionThreads);
 	unsigned int num_built = ptb->buildTransitions( srcAnim, trgAnim, mWndLength, mMinDist );
 	delete ptb;
 
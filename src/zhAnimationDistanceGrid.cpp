@@ -22,10 +22,385 @@ SOFTWARE.
 
 #include "zhAnimationDistanceGrid.h"
 #include "zhAnimation.h"
+#include "zhPose.h"
+#include "zhThreadPool.h"
+
+#if zhSSE_Enabled
+#include <xmmintrin.h>
+#endif
 
 namespace zh
 {
 
+/**
+* Computes weighted sums of products of marker coordinates
+* for a pair of frames. Each frame holds x[], y[] and z[] arrays
+* of numBones marker coordinates, where numBones is a multiple of 4
+* and markers of frame 1 are premultiplied by bone weights.
+*/
+static void ComputeMarkerProducts( const float* pos1, const float* pos2, unsigned int numBones,
+								  float& xxzz, float& xzzx, float& yy )
+{
+	const float* x1 = pos1;
+	const float* y1 = pos1 + numBones;
+	const float* z1 = pos1 + 2 * numBones;
+	const float* x2 = pos2;
+	const float* y2 = pos2 + numBones;
+	const float* z2 = pos2 + 2 * numBones;
+
+#if zhSSE_Enabled
+	__m128 sxxzz = _mm_setzero_ps(),
+		sxzzx = _mm_setzero_ps(),
+		syy = _mm_setzero_ps();
+
+	for( unsigned int bi = 0; bi < numBones; bi += 4 )
+	{
+		__m128 vx1 = _mm_loadu_ps( x1 + bi ), vz1 = _mm_loadu_ps( z1 + bi ),
+			vx2 = _mm_loadu_ps( x2 + bi ), vz2 = _mm_loadu_ps( z2 + bi );
+
+		sxxzz = _mm_add_ps( sxxzz, _mm_add_ps( _mm_mul_ps( vx1, vx2 ), _mm_mul_ps( vz1, vz2 ) ) );
+		sxzzx = _mm_add_ps( sxzzx, _mm_sub_ps( _mm_mul_ps( vx1, vz2 ), _mm_mul_ps( vz1, vx2 ) ) );
+		syy = _mm_add_ps( syy, _mm_mul_ps( _mm_loadu_ps( y1 + bi ), _mm_loadu_ps( y2 + bi ) ) );
+	}
+
+	// horizontal sums
+	float s[4];
+	_mm_storeu_ps( s, sxxzz );
+	xxzz = ( s[0] + s[1] ) + ( s[2] + s[3] );
+	_mm_storeu_ps( s, sxzzx );
+	xzzx = ( s[0] + s[1] ) + ( s[2] + s[3] );
+	_mm_storeu_ps( s, syy );
+	yy = ( s[0] + s[1] ) + ( s[2] + s[3] );
+#else
+	xxzz = xzzx = yy = 0;
+
+	for( unsigned int bi = 0; bi < numBones; ++bi )
+	{
+		xxzz += x1[bi] * x2[bi] + z1[bi] * z2[bi];
+		xzzx += x1[bi] * z2[bi] - z1[bi] * x2[bi];
+		yy += y1[bi] * y2[bi];
+	}
+#endif
+}
+
+/**
+* Computes sums of a sequence weighted by the animation window,
+* w(k) = box + tent * ( h + 1 - |k| ) for |k| <= h, at n consecutive points.
+* The sequence holds h extra samples before the first point and after the last one.
+* The tent is a box of width h + 1 applied twice, so both filters
+* are evaluated from running sums, in time independent of h.
+*/
+static void FilterWindow( const std::vector<double>& seq, unsigned int n, unsigned int h,
+						 double box, double tent, std::vector<double>& buf, double* sums )
+{
+	zhAssert( seq.size() == n + 2 * h );
+
+	unsigned int len = n + 2 * h;
+	buf.resize( ( len + 1 ) + ( n + h + 1 ) );
+	double* seq_sum = &buf[0]; // running sums of the sequence
+	double* box_sum = seq_sum + len + 1; // running sums of the sequence filtered by a box of width h + 1
+
+	seq_sum[0] = 0;
+	for( unsigned int ei = 0; ei < len; ++ei )
+		seq_sum[ei+1] = seq_sum[ei] + seq[ei];
+
+	box_sum[0] = 0;
+	for( unsigned int ei = 0; ei < n + h; ++ei )
+		box_sum[ei+1] = box_sum[ei] + ( seq_sum[ei+h+1] - seq_sum[ei] );
+
+	for( unsigned int pi = 0; pi < n; ++pi )
+	{
+		// box of width 2h + 1 is made of two overlapping boxes of width h + 1
+		double sum_box = ( box_sum[pi+1] - box_sum[pi] ) + ( box_sum[pi+h+1] - box_sum[pi+h] ) - seq[pi+h];
+		double sum_tent = box_sum[pi+h+1] - box_sum[pi];
+
+		sums[pi] = box * sum_box + tent * sum_tent;
+	}
+}
+
+/**
+* @brief Intermediate data shared by the tasks building a distance grid.
+*/
+struct DistanceGridBuildData
+{
+	unsigned int mNumSamples1; ///< Number of sample frames of animation 1.
+	unsigned int mNumSamples2; ///< Number of sample frames of animation 2.
+	unsigned int mNumBones4; ///< Bone count padded for SIMD.
+	unsigned int mFrameStride; ///< Offset between frames in marker position arrays.
+	std::vector<float> mBoneWeights; ///< Bone weights by bone index.
+
+	// marker positions are stored per frame as x[], y[], z[] arrays,
+	// padding markers are zero and contribute nothing
+	std::vector<float> mPos1; ///< Marker positions 1, premultiplied by bone weights.
+	std::vector<float> mPos2; ///< Marker positions 2.
+	std::vector<Vector3> mAvgPos1; ///< Weighted averages of marker positions 1.
+	std::vector<Vector3> mAvgPos2; ///< Weighted averages of marker positions 2.
+	std::vector<float> mAvgPoslen1; ///< Weighted averages of squared lengths of marker positions 1.
+	std::vector<float> mAvgPoslen2; ///< Weighted averages of squared lengths of marker positions 2.
+
+	std::vector<float> mAvgXxzz; ///< Weighted averages of combined marker positions (1).
+	std::vector<float> mAvgXzzx; ///< Weighted averages of combined marker positions (2).
+	std::vector<float> mAvgYy; ///< Weighted averages of combined marker positions (3).
+
+	unsigned int mWndHalfLength; ///< Number of samples in one half of anim. window.
+	double mWndBox; ///< Box filter weight of the anim. window.
+	double mWndTent; ///< Tent filter weight of the anim. window.
+	std::vector<double> mSumPos1x, mSumPos1z, mSumPoslen1; ///< Window sums over animation 1.
+	std::vector<double> mSumPos2x, mSumPos2z, mSumPoslen2; ///< Window sums over animation 2.
+
+	const std::vector<bool>* mRegion; ///< Grid points which should be computed (NULL if all).
+	std::vector<bool> mProductRegion; ///< Grid points at which combined marker positions are needed (empty if all).
+	std::vector<AnimationDistanceGrid::Point>* mGrid; ///< Grid points.
+	std::vector<float> mMinDist; ///< Minimum distances, one per distance task.
+	std::vector<float> mMaxDist; ///< Maximum distances, one per distance task.
+};
+
+/**
+* @brief Task which samples marker positions for a tile of frames
+* of one animation.
+*/
+class MarkerSampleTask : public ThreadPool::Task
+{
+
+public:
+
+	MarkerSampleTask( DistanceGridBuildData& data, Skeleton* skel, const AnimationSegment& anim,
+		unsigned int sampleRate, bool anim1 )
+		: mData(data), mSkel(skel), mAnim(anim), mSampleRate(sampleRate),
+		mPos( anim1 ? data.mPos1 : data.mPos2 ),
+		mAvgPos( anim1 ? data.mAvgPos1 : data.mAvgPos2 ),
+		mAvgPoslen( anim1 ? data.mAvgPoslen1 : data.mAvgPoslen2 ),
+		mPremultiply(anim1)
+	{
+	}
+
+	void operator()( unsigned int tileIndex )
+	{
+		float dt = 1.f / mSampleRate; // offset between samples (poses)
+		unsigned int num_samples = mAvgPos.size();
+		unsigned int num_bones = mSkel->getNumBones();
+
+		// poses are sampled into a local buffer, so the skeleton is never modified
+		Pose pose(mSkel);
+		std::vector<Vector3> wpos_buf, wscal_buf;
+		std::vector<Quat> worient_buf;
+		KeyFrameCursor kfcur;
+
+		unsigned int si_end = std::min( num_samples, ( tileIndex + 1 ) * zhAnimationDistanceGrid_TileSize );
+		for( unsigned int si = tileIndex * zhAnimationDistanceGrid_TileSize; si < si_end; ++si )
+		{
+			float t = mAnim.getStartTime() + si * dt;
+
+			pose.reset();
+			mAnim.getAnimation()->sample( t, pose, Animation::EmptyBoneMask, &kfcur );
+			pose.computeWorldTransforms( wpos_buf, worient_buf, wscal_buf );
+
+			float* px = &mPos[ si * mData.mFrameStride ];
+			float* py = px + mData.mNumBones4;
+			float* pz = py + mData.mNumBones4;
+			for( unsigned int bone_i0 = 0; bone_i0 < num_bones; ++bone_i0 )
+			{
+				const Vector3& wpos = wpos_buf[bone_i0];
+				float w = mData.mBoneWeights[bone_i0];
+				float pw = mPremultiply ? w : 1.f;
+
+				px[bone_i0] = wpos.x * pw;
+				py[bone_i0] = wpos.y * pw;
+				pz[bone_i0] = wpos.z * pw;
+				mAvgPos[si] += wpos * w;
+				mAvgPoslen[si] += wpos.lengthSq() * w;
+			}
+		}
+	}
+
+	void call( unsigned int tileIndex )
+	{
+		(*this)(tileIndex);
+	}
+
+private:
+
+	DistanceGridBuildData& mData;
+	Skeleton* mSkel;
+	const AnimationSegment& mAnim;
+	unsigned int mSampleRate;
+	std::vector<float>& mPos;
+	std::vector<Vector3>& mAvgPos;
+	std::vector<float>& mAvgPoslen;
+	bool mPremultiply;
+
+};
+
+/**
+* @brief Task which computes weighted averages of combined
+* marker positions for a tile of grid rows.
+*/
+class MarkerProductTask : public ThreadPool::Task
+{
+
+public:
+
+	MarkerProductTask( DistanceGridBuildData& data ) : mData(data)
+	{
+	}
+
+	void operator()( unsigned int tileIndex )
+	{
+		unsigned int si2_start = tileIndex * zhAnimationDistanceGrid_TileSize;
+		unsigned int si2_end = std::min( mData.mNumSamples2, si2_start + zhAnimationDistanceGrid_TileSize );
+
+		// walk the rows in square blocks, so both sets of frames stay in cache
+		for( unsigned int si1_start = 0; si1_start < mData.mNumSamples1; si1_start += zhAnimationDistanceGrid_TileSize )
+		{
+			unsigned int si1_end = std::min( mData.mNumSamples1, si1_start + zhAnimationDistanceGrid_TileSize );
+
+			for( unsigned int si2 = si2_start; si2 < si2_end; ++si2 )
+			{
+				const float* pos2_si = &mData.mPos2[ si2 * mData.mFrameStride ];
+
+				for( unsigned int si1 = si1_start; si1 < si1_end; ++si1 )
+				{
+					unsigned int pti = si1 + si2 * mData.mNumSamples1;
+					if( !mData.mProductRegion.empty() && !mData.mProductRegion[pti] )
+						continue;
+
+					ComputeMarkerProducts( &mData.mPos1[ si1 * mData.mFrameStride ], pos2_si, mData.mNumBones4,
+						mData.mAvgXxzz[pti], mData.mAvgXzzx[pti], mData.mAvgYy[pti] );
+				}
+			}
+		}
+	}
+
+	void call( unsigned int tileIndex )
+	{
+		(*this)(tileIndex);
+	}
+
+private:
+
+	DistanceGridBuildData& mData;
+
+};
+
+/**
+* @brief Task which computes distances and align. transf.
+* for a tile of grid diagonals.
+*/
+class DistanceTask : public ThreadPool::Task
+{
+
+public:
+
+	DistanceTask( DistanceGridBuildData& data ) : mData(data)
+	{
+	}
+
+	void operator()( unsigned int tileIndex )
+	{
+		unsigned int num_samples1 = mData.mNumSamples1, num_samples2 = mData.mNumSamples2;
+		unsigned int num_samples = mData.mWndHalfLength;
+		std::vector<double> seq, wnd_buf, sum_xzzx, sum_xxzz, sum_yy;
+		float min_dist = FLT_MAX, max_dist = 0;
+
+		// diagonals are numbered from the bottom-right corner of the grid
+		int diag_start = 1 - (int)num_samples1 + (int)( tileIndex * zhAnimationDistanceGrid_TileSize );
+		int diag_end = std::min( (int)num_samples2, diag_start + zhAnimationDistanceGrid_TileSize );
+		for( int diag = diag_start; diag < diag_end; ++diag )
+		{
+			unsigned int si1_start = diag < 0 ? -diag : 0;
+			unsigned int si1_end = std::min( num_samples1, num_samples2 - diag );
+			unsigned int num_cells = si1_end - si1_start;
+
+			// points outside the region are not computed
+			bool in_region = mData.mRegion == NULL;
+			for( unsigned int ci = 0; ci < num_cells && mData.mRegion != NULL; ++ci )
+			{
+				unsigned int si1 = si1_start + ci;
+				unsigned int si2 = si1 + diag;
+
+				if( (*mData.mRegion)[ si1 + num_samples1 * si2 ] )
+					in_region = true;
+				else
+					(*mData.mGrid)[ si1 + num_samples1 * si2 ] = AnimationDistanceGrid::Point( AnimationDistanceGrid::Index( si1, si2 ),
+						FLT_MAX, Skeleton::Situation::Identity );
+			}
+
+			if( !in_region )
+				continue;
+
+			sum_xzzx.resize(num_cells);
+			sum_xxzz.resize(num_cells);
+			sum_yy.resize(num_cells);
+
+			seq.resize( num_cells + 2 * num_samples );
+			const std::vector<float>* avgs[] = { &mData.mAvgXzzx, &mData.mAvgXxzz, &mData.mAvgYy };
+			std::vector<double>* sums[] = { &sum_xzzx, &sum_xxzz, &sum_yy };
+			for( unsigned int ci = 0; ci < 3; ++ci )
+			{
+				for( unsigned int ei = 0; ei < seq.size(); ++ei )
+				{
+					int si0_1 = (int)( si1_start + ei ) - (int)num_samples;
+					if( si0_1 < 0 ) si0_1 = 0;
+					else if( si0_1 >= (int)num_samples1 ) si0_1 = (int)num_samples1 - 1;
+
+					int si0_2 = (int)( si1_start + ei ) - (int)num_samples + diag;
+					if( si0_2 < 0 ) si0_2 = 0;
+					else if( si0_2 >= (int)num_samples2 ) si0_2 = (int)num_samples2 - 1;
+
+					seq[ei] = (*avgs[ci])[ si0_1 + si0_2 * num_samples1 ];
+				}
+
+				FilterWindow( seq, num_cells, num_samples, mData.mWndBox, mData.mWndTent, wnd_buf, &(*sums[ci])[0] );
+			}
+
+			for( unsigned int ci = 0; ci < num_cells; ++ci )
+			{
+				unsigned int si1 = si1_start + ci;
+				unsigned int si2 = si1 + diag;
+				if( mData.mRegion != NULL && !(*mData.mRegion)[ si1 + num_samples1 * si2 ] )
+					continue;
+
+				double A = sum_xzzx[ci], B = mData.mSumPos1x[si1], C = mData.mSumPos2z[si2],
+					D = mData.mSumPos1z[si1], E = mData.mSumPos2x[si2], F = sum_xxzz[ci];
+
+				// compute distance and align. transf. for current frame pair
+				float orient_y = (float)atan2( A - ( B * C - D * E ), F - ( B * E + D * C ) );
+				double cos_y = cos(orient_y), sin_y = sin(orient_y);
+				double pos_x = B - E * cos_y - C * sin_y,
+					pos_z = D + E * sin_y - C * cos_y;
+
+				// compute distance
+				double G = - F + pos_x * E + pos_z * C;
+				double H = - A + pos_x * C - pos_z * E;
+				double I = - sum_yy[ci] - pos_x * B - pos_z * D;
+				float dist = (float)( pos_x * pos_x + pos_z * pos_z +
+					mData.mSumPoslen1[si1] + mData.mSumPoslen2[si2] +
+					2 * ( G * cos_y + H * sin_y + I ) );
+
+				dist = dist >= 0 ? dist : 0;
+				if( dist < min_dist ) min_dist = dist;
+				if( dist > max_dist ) max_dist = dist;
+
+				(*mData.mGrid)[ si1 + num_samples1 * si2 ] = AnimationDistanceGrid::Point( AnimationDistanceGrid::Index( si1, si2 ),
+					dist, Skeleton::Situation( (float)pos_x, (float)pos_z, orient_y ) );
+			}
+		}
+
+		mData.mMinDist[tileIndex] = min_dist;
+		mData.mMaxDist[tileIndex] = max_dist;
+	}
+
+	void call( unsigned int tileIndex )
+	{
+		(*this)(tileIndex);
+	}
+
+private:
+
+	DistanceGridBuildData& mData;
+
+};
+
 AnimationDistanceGrid::AnimationDistanceGrid( Skeleton* skel, const AnimationSegment& anim1, const AnimationSegment& anim2, unsigned int sampleRate )
 : mSkel(skel), mAnim1(anim1), mAnim2(anim2), mSampleRate(sampleRate), mWndLen(0), mMinDist(0)
 {
@@ -134,7 +509,19 @@ unsigned int AnimationDistanceGrid::getSampleRate() const
 	return mSampleRate;
 }
 
-void AnimationDistanceGrid::build( float wndLength )
+void AnimationDistanceGrid::build( float wndLength, ThreadPool* threadPool )
+{
+	_build( wndLength, threadPool, NULL );
+}
+
+void AnimationDistanceGrid::build( const std::vector<bool>& region, float wndLength, ThreadPool* threadPool )
+{
+	zhAssert( region.size() == mGrid.size() );
+
+	_build( wndLength, threadPool, &region );
+}
+
+void AnimationDistanceGrid::_build( float wndLength, ThreadPool* threadPool, const std::vector<bool>* region )
 {
 	zhAssert( wndLength >= 0 );
 
@@ -149,92 +536,41 @@ void AnimationDistanceGrid::build( float wndLength )
 	mWndLen = wndLength;
 
 	float dt = 1.f / mSampleRate; // offset between samples (poses)
-	std::vector<Vector3> pos1( mNumSamples1 * mSkel->getNumBones() ); // marker positions 1
-	std::vector<Vector3> pos2( mNumSamples2 * mSkel->getNumBones() ); // marker positions 2
-	std::vector<Vector3> avg_pos1( mNumSamples1 ); // weighted averages of marker positions 1
-	std::vector<Vector3> avg_pos2( mNumSamples2 ); // weighted averages of marker positions 2
-	std::vector<float> avg_poslen1( mNumSamples1 ); // weighted averages of squared lengths of marker positions 1
-	std::vector<float> avg_poslen2( mNumSamples2 ); // weighted averages of squared lengths of marker positions 2
-
-	// compute marker positions for animation 1
-	for( unsigned int si = 0; si < mNumSamples1; ++si )
-	{
-		float t = mAnim1.getStartTime() + si * dt;
-
-		mSkel->resetToInitialPose();
-		mAnim1.getAnimation()->apply( mSkel, t, 1, 1, Animation::EmptyBoneMask );
-
-		Skeleton::BoneConstIterator bone_i = mSkel->getBoneConstIterator();
-		unsigned bone_i0 = 0;
-		Vector3 wpos;
-		while( !bone_i.end() )
-		{
-			Bone* bone = bone_i.next();
-
-			wpos = bone->getWorldPosition();
-			pos1[ (bone_i0++) + si * mSkel->getNumBones() ] = wpos;
-			avg_pos1[si] += wpos * mBoneWeights[ bone->getId() ];
-			avg_poslen1[si] += wpos.lengthSq() * mBoneWeights[ bone->getId() ];
-		}
-	}
-
-	// compute marker positions for animation 2
-	for( unsigned int si = 0; si < mNumSamples2; ++si )
-	{
-		float t = mAnim2.getStartTime() + si * dt;
-
-		mSkel->resetToInitialPose();
-		mAnim2.getAnimation()->apply( mSkel, t, 1, 1, Animation::EmptyBoneMask );
-
-		Skeleton::BoneConstIterator bone_i = mSkel->getBoneConstIterator();
-		unsigned bone_i0 = 0;
-		Vector3 wpos;
-		while( !bone_i.end() )
-		{
-			Bone* bone = bone_i.next();
-
-			wpos = bone->getWorldPosition();
-			pos2[ (bone_i0++) + si * mSkel->getNumBones() ] = wpos;
-			avg_pos2[si] += wpos * mBoneWeights[ bone->getId() ];
-			avg_poslen2[si] += wpos.lengthSq() * mBoneWeights[ bone->getId() ];
-		}
-	}
-	
-	// reset skeleton to initial pose and don't touch it anymore
-	mSkel->resetToInitialPose();
-
-	std::vector<float> avg_xxzz( mNumSamples1 * mNumSamples2, 0 ); // weighted averages of combined marker positions (1)
-	std::vector<float> avg_xzzx( mNumSamples1 * mNumSamples2, 0 ); // weighted averages of marker positions (2)
-	std::vector<float> avg_yy( mNumSamples1 * mNumSamples2, 0 ); // weighted averages of marker positions (3)
-
-	// compute weighted averages of combined marker positions
-	for( unsigned int si2 = 0; si2 < mNumSamples2; ++si2 )
-	{
-		for( unsigned int si1 = 0; si1 < mNumSamples1; ++si1 )
-		{
-			Skeleton::BoneConstIterator bone_i = mSkel->getBoneConstIterator();
-			unsigned bone_i0 = 0;
-			while( !bone_i.end() )
-			{
-				Bone* bone = bone_i.next();
-
-				unsigned int pti = si1 + si2 * mNumSamples1,
-					pti1 = bone_i0 + si1 * mSkel->getNumBones(),
-					pti2 = bone_i0 + si2 * mSkel->getNumBones();
-
-				avg_xxzz[pti] +=
-					( pos1[pti1].x * pos2[pti2].x + pos1[pti1].z * pos2[pti2].z ) *
-					mBoneWeights[ bone->getId() ];
-				avg_xzzx[pti] +=
-					( pos1[pti1].x * pos2[pti2].z -	pos1[pti1].z * pos2[pti2].x ) *
-					mBoneWeights[ bone->getId() ];
-				avg_yy[pti] +=
-					( pos1[pti1].y * pos2[pti2].y ) *
-					mBoneWeights[ bone->getId() ];
-				++bone_i0;
-			}
-		}
-	}
+	unsigned int num_bones = mSkel->getNumBones();
+
+	DistanceGridBuildData data;
+	data.mNumSamples1 = mNumSamples1;
+	data.mNumSamples2 = mNumSamples2;
+	data.mNumBones4 = ( num_bones + 3 ) & ~3u;
+	data.mFrameStride = 3 * data.mNumBones4;
+	data.mPos1.resize( mNumSamples1 * data.mFrameStride, 0 );
+	data.mPos2.resize( mNumSamples2 * data.mFrameStride, 0 );
+	data.mAvgPos1.resize( mNumSamples1 );
+	data.mAvgPos2.resize( mNumSamples2 );
+	data.mAvgPoslen1.resize( mNumSamples1, 0 );
+	data.mAvgPoslen2.resize( mNumSamples2, 0 );
+	data.mGrid = &mGrid;
+	data.mRegion = region;
+
+	// look up bone weights by bone index
+	data.mBoneWeights.resize(num_bones);
+	for( unsigned int bone_i0 = 0; bone_i0 < num_bones; ++bone_i0 )
+		data.mBoneWeights[bone_i0] = getBoneWeight( mSkel->getBoneByIndex(bone_i0)->getId() );
+
+	// workers only read the skeleton, but its topology
+	// is computed lazily, so compute it before any workers start
+	mSkel->getParentIndices();
+
+	// without a pool, run all tasks on the calling thread
+	ThreadPool local_pool;
+	ThreadPool& pool = threadPool != NULL ? *threadPool : local_pool;
+	unsigned int tile_size = zhAnimationDistanceGrid_TileSize;
+
+	// compute marker positions for both animations
+	MarkerSampleTask sample_task1( data, mSkel, mAnim1, mSampleRate, true );
+	pool.run( ( mNumSamples1 + tile_size - 1 ) / tile_size, sample_task1 );
+	MarkerSampleTask sample_task2( data, mSkel, mAnim2, mSampleRate, false );
+	pool.run( ( mNumSamples2 + tile_size - 1 ) / tile_size, sample_task2 );
 
 	unsigned int num_samples = unsigned int( wndLength / dt + 0.5f );
 	num_samples = num_samples % 2 != 0 ? num_samples : num_samples + 1;
@@ -243,88 +579,108 @@ void AnimationDistanceGrid::build( float wndLength )
 
 	float w_max = 1.f / ( num_samples/2 + 1 ); // maximum frame weight value
 	float w_min = w_max * w_max; // minimum frame weight value
-	std::vector<float> weights( num_samples, 0 ); // frame weight values
-
-	// compute frame weight values
-	for( unsigned int wsi = 0; wsi < num_samples; ++wsi )
-	{
-		weights[wsi] = w_min + ( w_max - w_min ) / ((float)(num_samples/2)) * 
-			( wsi <= num_samples/2 ? wsi : ( num_samples - 1 - wsi ) );
-	}
 
 	num_samples = ( num_samples - 1 ) / 2; // number of samples in one half of anim. window
 
-	// compute distances and align. transf. between frame pairs
-	for( unsigned int si2 = 0; si2 < mNumSamples2; ++si2 )
+	// frame weights fall off linearly from the window center,
+	// w(k) = w_min + ( w_max - w_min ) / h * ( h - |k| ),
+	// which is rewritten as a box and a tent filter
+	data.mWndHalfLength = num_samples;
+	data.mWndTent = num_samples > 0 ? ( w_max - w_min ) / num_samples : 0;
+	data.mWndBox = w_min - data.mWndTent;
+
+	if( region != NULL )
 	{
-		for( unsigned int si1 = 0; si1 < mNumSamples1; ++si1 )
+		// combined marker positions are needed wherever the anim. window
+		// of some point in the region reaches, i.e. along grid diagonals
+		std::vector<unsigned int> num_region; // running counts of region points along a diagonal
+		data.mProductRegion.assign( mNumSamples1 * mNumSamples2, false );
+		for( int diag = 1 - (int)mNumSamples1; diag < (int)mNumSamples2; ++diag )
 		{
-			unsigned int si0_1 = 0;
-			unsigned int si0_2 = 0;
-			float A, B, C, D, E, F;
-			A = B = C = D = E = F = 0;
-			float dist = 0;
-
-			// compute sumation terms in align. transf. formulas
-			for( int wsi = - (int)num_samples; wsi <= (int)num_samples; ++wsi )
-			{
-				int si0_1 = (int)si1 + wsi;
-				if( si0_1 < 0 ) si0_1 = 0;
-				else if( si0_1 >= (int)mNumSamples1 ) si0_1 = mNumSamples1 - 1;
-
-				int si0_2 = (int)si2 + wsi;
-				if( si0_2 < 0 ) si0_2 = 0;
-				else if( si0_2 >= (int)mNumSamples2 ) si0_2 = mNumSamples2 - 1;
-
-				unsigned int pti = si0_1 + si0_2 * mNumSamples1;
+			unsigned int si1_start = diag < 0 ? -diag : 0;
+			unsigned int si1_end = std::min( mNumSamples1, mNumSamples2 - diag );
+			unsigned int num_cells = si1_end - si1_start;
 
-				A += weights[ wsi + num_samples ] * avg_xzzx[pti];
-				B += weights[ wsi + num_samples ] * avg_pos1[si0_1].x;
-				C += weights[ wsi + num_samples ] * avg_pos2[si0_2].z;
-				D += weights[ wsi + num_samples ] * avg_pos1[si0_1].z;
-				E += weights[ wsi + num_samples ] * avg_pos2[si0_2].x;
-				F += weights[ wsi + num_samples ] * avg_xxzz[pti];
-			}
+			num_region.resize( num_cells + 1 );
+			num_region[0] = 0;
+			for( unsigned int ci = 0; ci < num_cells; ++ci )
+				num_region[ci+1] = num_region[ci] + ( (*region)[ si1_start + ci + mNumSamples1 * ( si1_start + ci + diag ) ] ? 1 : 0 );
 
-			// compute distance and align. transf. for current frame pair
-			float orient_y = atan2( A - ( B * C - D * E ), F - ( B * E + D * C ) );
-			float pos_x = B - E * cos(orient_y) - C * sin(orient_y),
-				pos_z = D + E * sin(orient_y) - C * cos(orient_y);
+			if( num_region[num_cells] <= 0 )
+				continue;
 
-			// compute distance
-			dist = pos_x * pos_x + pos_z * pos_z;
-			for( int wsi = - (int)num_samples; wsi <= (int)num_samples; ++wsi )
+			// the window of the point at ci covers window samples [ci, ci + 2h]
+			for( unsigned int ei = 0; ei < num_cells + 2 * num_samples; ++ei )
 			{
-				int si0_1 = (int)si1 + wsi;
+				unsigned int ci_start = ei > 2 * num_samples ? ei - 2 * num_samples : 0;
+				unsigned int ci_end = std::min( num_cells, ei + 1 );
+				if( ci_start >= ci_end || num_region[ci_end] <= num_region[ci_start] )
+					continue;
+
+				int si0_1 = (int)( si1_start + ei ) - (int)num_samples;
 				if( si0_1 < 0 ) si0_1 = 0;
 				else if( si0_1 >= (int)mNumSamples1 ) si0_1 = (int)mNumSamples1 - 1;
 
-				int si0_2 = (int)si2 + wsi;
+				int si0_2 = (int)( si1_start + ei ) - (int)num_samples + diag;
 				if( si0_2 < 0 ) si0_2 = 0;
 				else if( si0_2 >= (int)mNumSamples2 ) si0_2 = (int)mNumSamples2 - 1;
 
-				unsigned int pti = si0_1 + si0_2 * mNumSamples1;
-
-				float G, H, I;
-				G = - avg_xxzz[pti] +
-					pos_x * avg_pos2[si0_2].x + pos_z * avg_pos2[si0_2].z;
-				H = - avg_xzzx[pti] +
-					pos_x * avg_pos2[si0_2].z - pos_z * avg_pos2[si0_2].x;
-				I = - avg_yy[pti] -
-					pos_x * avg_pos1[si0_1].x - pos_z * avg_pos1[si0_1].z;
-
-				dist += weights[ wsi + num_samples ] * (
-					avg_poslen1[si0_1] + avg_poslen2[si0_2] +
-					2 * ( G * cos(orient_y) + H * sin(orient_y) + I )
-					);
+				data.mProductRegion[ si0_1 + si0_2 * mNumSamples1 ] = true;
 			}
+		}
+	}
 
-			dist = dist >= 0 ? dist : 0;
-			if( dist < mMinDist ) mMinDist = dist;
-			if( dist > mMaxDist ) mMaxDist = dist;
+	// compute weighted averages of combined marker positions
+	data.mAvgXxzz.resize( mNumSamples1 * mNumSamples2, 0 );
+	data.mAvgXzzx.resize( mNumSamples1 * mNumSamples2, 0 );
+	data.mAvgYy.resize( mNumSamples1 * mNumSamples2, 0 );
+	MarkerProductTask product_task(data);
+	pool.run( ( mNumSamples2 + tile_size - 1 ) / tile_size, product_task );
+
+	// window sums which depend on only one of the animations
+	std::vector<double> seq, wnd_buf;
+	data.mSumPos1x.resize( mNumSamples1 );
+	data.mSumPos1z.resize( mNumSamples1 );
+	data.mSumPoslen1.resize( mNumSamples1 );
+	data.mSumPos2x.resize( mNumSamples2 );
+	data.mSumPos2z.resize( mNumSamples2 );
+	data.mSumPoslen2.resize( mNumSamples2 );
+	std::vector<double>* sums[] = { &data.mSumPos1x, &data.mSumPos1z, &data.mSumPoslen1,
+		&data.mSumPos2x, &data.mSumPos2z, &data.mSumPoslen2 };
+	for( unsigned int ci = 0; ci < 6; ++ci )
+	{
+		bool anim1 = ci < 3;
+		unsigned int num_samples0 = anim1 ? mNumSamples1 : mNumSamples2;
+		const std::vector<Vector3>& avg_pos = anim1 ? data.mAvgPos1 : data.mAvgPos2;
+		const std::vector<float>& avg_poslen = anim1 ? data.mAvgPoslen1 : data.mAvgPoslen2;
+
+		seq.resize( num_samples0 + 2 * num_samples );
+		for( unsigned int ei = 0; ei < seq.size(); ++ei )
+		{
+			int si0 = (int)ei - (int)num_samples;
+			if( si0 < 0 ) si0 = 0;
+			else if( si0 >= (int)num_samples0 ) si0 = (int)num_samples0 - 1;
 
-			mGrid[ si1 + mNumSamples1 * si2 ] = Point( Index( si1, si2 ), dist, Skeleton::Situation( pos_x, pos_z, orient_y ) );
+			if( ci % 3 == 0 ) seq[ei] = avg_pos[si0].x;
+			else if( ci % 3 == 1 ) seq[ei] = avg_pos[si0].z;
+			else seq[ei] = avg_poslen[si0];
 		}
+
+		FilterWindow( seq, num_samples0, num_samples, data.mWndBox, data.mWndTent, wnd_buf, &(*sums[ci])[0] );
+	}
+
+	// compute distances and align. transf. between frame pairs,
+	// in tiles of grid diagonals, since the window slides along diagonals
+	unsigned int num_dist_tasks = ( mNumSamples1 + mNumSamples2 - 1 + tile_size - 1 ) / tile_size;
+	data.mMinDist.resize( num_dist_tasks, FLT_MAX );
+	data.mMaxDist.resize( num_dist_tasks, 0 );
+	DistanceTask dist_task(data);
+	pool.run( num_dist_tasks, dist_task );
+
+	for( unsigned int ti = 0; ti < num_dist_tasks; ++ti )
+	{
+		if( data.mMinDist[ti] < mMinDist ) mMinDist = data.mMinDist[ti];
+		if( data.mMaxDist[ti] > mMaxDist ) mMaxDist = data.mMaxDist[ti];
 	}
 
 	zhLog( "AnimationDistanceGrid", "build", "Finished building distance grid for animation segments %u, %s [%f - %f] and %u, %s [%f - %f].",
@@ -364,6 +720,16 @@ float AnimationDistanceGrid::getNormDistance( const Index& index ) const
 	return ( getDistance(index) - mMinDist ) / ( mMaxDist - mMinDist );
 }
 
+float AnimationDistanceGrid::getMinDistance() const
+{
+	return mMinDist;
+}
+
+float AnimationDistanceGrid::getMaxDistance() const
+{
+	return mMaxDist;
+}
+
 void AnimationDistanceGrid::setDistance( const Index& index, float dist )
 {
 	zhAssert( index.first < mNumSamples1 && index.second < mNumSamples2 );
@@ -628,12 +994,12 @@ float AnimationDistanceGrid::_computeOptimalPathSegment( const Index& srcIndex,
 				j2 = i2 + j;
 
 			if( j1 <= dstIndex.first && i2 <= dstIndex.second )
-				dtw_annots[ Index( j1, i2 ) ] = _DTW( Index( j1, i2 ), dtw_annots );
+				_annotateDTW( Index( j1, i2 ), srcIndex, dtw_annots );
 				//path.push_back( Index( j1, i2 ) );
 
 			if( j2 > 0 &&
 				i1 <= dstIndex.first && j2 <= dstIndex.second )
-				dtw_annots[ Index( i1, j2 ) ] = _DTW( Index( i1, j2 ), dtw_annots );
+				_annotateDTW( Index( i1, j2 ), srcIndex, dtw_annots );
 				//path.push_back( Index( i1, j2 ) );
 		}
 	}
@@ -689,6 +1055,23 @@ float AnimationDistanceGrid::_computeOptimalPathSegment( const Index& srcIndex,
 	return d;
 }
 
+void AnimationDistanceGrid::_annotateDTW( const Index& ptIndex, const Index& srcIndex, std::map<Index,_DTWAnnot>& dtwAnnots ) const
+{
+	// points which haven't been computed are outside the search area
+	if( getDistance(ptIndex) >= FLT_MAX )
+		return;
+
+	_DTWAnnot annot = _DTW( ptIndex, dtwAnnots );
+
+	// points past the first row and column of the search area
+	// are unreachable if they have no predecessor in it
+	if( annot.prev == ptIndex &&
+		ptIndex.first > srcIndex.first && ptIndex.second > srcIndex.second )
+		return;
+
+	dtwAnnots[ptIndex] = annot;
+}
+
 AnimationDistanceGrid::_DTWAnnot AnimationDistanceGrid::_DTW( const Index& ptIndex, const std::map<Index,_DTWAnnot>& dtwAnnots ) const
 {
 	float dmin_h = FLT_MAX,
@@ -750,7 +1133,8 @@ AnimationDistanceGrid::_DTWAnnot AnimationDistanceGrid::_DTW( const Index& ptInd
 	// choose the predecessor and return the annotation
 	if( dmin_v >= FLT_MAX && dmin_h >= FLT_MAX )
 	{
-		return _DTWAnnot( 0, Index( 0, 0 ) );
+		// no predecessor
+		return _DTWAnnot( 0, ptIndex );
 	}
 	else if( dmin_v < dmin_h )
 	{
@@ -37,18 +37,16 @@ AnimationFrame::AnimationFrame( Animation* anim, unsigned int frameIndex )
 	{
 		BoneAnimationTrack* btr = btr_i.next();
 		zhAssert( frameIndex < btr->getNumKeyFrames() );
-		TransformKeyFrame* tkf = static_cast<TransformKeyFrame*>( btr->getKeyFrame(frameIndex) );
-
 		if( btr->getBoneId() == 0 )
 		{
 			// Root bone
-			this->rootPosition = Vector3(0, tkf->getTranslation().y, 0);
-			Quat q = tkf->getRotation().log();
+			this->rootPosition = Vector3(0, btr->getKeyFrameTranslation(frameIndex).y, 0);
+			Quat q = btr->getKeyFrameRotation(frameIndex).log();
 			this->rootOrientation = Quat(q.x, 0, q.z);
 		}
 		else
 			// Some joint
-			this->orientations.push_back( tkf->getRotation().log() );
+			this->orientations.push_back( btr->getKeyFrameRotation(frameIndex).log() );
 	}
 }
 
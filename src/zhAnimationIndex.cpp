@@ -23,6 +23,7 @@ SOFTWARE.
 #include "zhAnimationIndex.h"
 #include "zhAnimationDatabaseSystem.h"
 #include "zhAnimation.h"
+#include "zhThreadPool.h"
 #include "rapidxml.hpp"
 #include "rapidxml_print.hpp"
 #include <queue>
@@ -91,9 +92,50 @@ unsigned int AnimationIndex::getNumAnimationSegments() const
 	return mAnimSegs.size();
 }
 
+/**
+* @brief Task which builds a single match web.
+*/
+class MatchWebBuildTask : public ThreadPool::Task
+{
+
+public:
+
+	MatchWebBuildTask( const std::vector<MatchWeb*>& matchWebs, unsigned int resampleFactor,
+		float wndLength, float minDist, float maxDistDiff,
+		float minChainLength, float maxBridgeLength )
+		: mMatchWebs(matchWebs), mResampleFact(resampleFactor),
+		mWndLength(wndLength), mMinDist(minDist), mMaxDistDiff(maxDistDiff),
+		mMinChainLength(minChainLength), mMaxBridgeLength(maxBridgeLength)
+	{
+	}
+
+	void operator()( unsigned int mwIndex )
+	{
+		mMatchWebs[mwIndex]->build( mResampleFact, mWndLength, mMinDist,
+			mMaxDistDiff, mMinChainLength, mMaxBridgeLength );
+	}
+
+	void call( unsigned int mwIndex )
+	{
+		(*this)(mwIndex);
+	}
+
+private:
+
+	const std::vector<MatchWeb*>& mMatchWebs;
+	unsigned int mResampleFact;
+	float mWndLength;
+	float mMinDist;
+	float mMaxDistDiff;
+	float mMinChainLength;
+	float mMaxBridgeLength;
+
+};
+
 void AnimationIndex::buildIndex( unsigned int resampleFactor,
 								float wndLength, float minDist, float maxDistDiff,
-								float minChainLength, float maxBridgeLength )
+								float minChainLength, float maxBridgeLength,
+								unsigned int numThreads )
 {
 	zhAssert( mSkel != NULL );
 
@@ -101,21 +143,39 @@ void AnimationIndex::buildIndex( unsigned int resampleFactor,
 
 	zhLog( "AnimationIndex", "buildIndex", "Building animation index %u.", mId );
 
-	// build match webs
+	// match webs only read the skeleton, but its root and topology
+	// are computed lazily, so compute them before any workers start
+	mSkel->getRoot();
+	mSkel->getParentIndices();
+
+	// get segment pairs for which match webs are needed
+	std::vector<MatchWeb::Index> mw_indices;
 	for( unsigned int seg1i = 0; seg1i < mAnimSegs.size(); ++seg1i )
-	{
 		for( unsigned int seg2i = 0; seg2i < mAnimSegs.size(); ++seg2i )
+			mw_indices.push_back( MatchWeb::Index( seg1i, seg2i ) );
+
+	// build match webs in batches, each batch in parallel
+	ThreadPool pool(numThreads);
+	unsigned int batch_size = pool.getNumWorkers() > 1 ? 4 * pool.getNumWorkers() : 1;
+	std::vector<MatchWeb*> batch;
+	MatchWebBuildTask task( batch, resampleFactor, wndLength, minDist,
+		maxDistDiff, minChainLength, maxBridgeLength );
+	for( unsigned int mwi0 = 0; mwi0 < mw_indices.size(); mwi0 += batch_size )
+	{
+		batch.clear();
+		for( unsigned int mwi = mwi0; mwi < mw_indices.size() && mwi < mwi0 + batch_size; ++mwi )
 		{
-			MatchWeb::Index mwi( seg1i, seg2i );
+			MatchWeb* mw = new MatchWeb( mw_indices[mwi], this, zhAnimation_SampleRate );
+			mw->setSkeleton(mSkel);
+			batch.push_back(mw);
+		}
 
-			if( hasMatchWeb(mwi) )
-				continue;
+		pool.run( batch.size(), task );
 
-			// we don't have a match web for this pair of animations, build one
-			MatchWeb* mw = new MatchWeb( mwi, this, zhAnimation_SampleRate );
-			mw->setSkeleton(mSkel);
-			mw->build( resampleFactor, wndLength, minDist, maxDistDiff, minChainLength, maxBridgeLength );
-			mMatchWebs[mwi] = mw;
+		for( unsigned int mwi = 0; mwi < batch.size(); ++mwi )
+		{
+			MatchWeb* mw = batch[mwi];
+			mMatchWebs[ mw->getIndex() ] = mw;
 
 			// notify listeners
 			MatchWebBuiltEvent evt( zhAnimationDatabaseSystem, mw );
@@ -84,11 +84,19 @@ void AnimationNode::addChild( AnimationNode* node )
 	mChildrenById.insert( make_pair( node->getId(), node ) );
 	mChildrenByName.insert( make_pair( node->getName(), node ) );
 
+	// keep child list ordered by ID
+	std::vector<AnimationNode*>::iterator ci = mChildren.begin();
+	while( ci != mChildren.end() && (*ci)->getId() < node->getId() )
+		++ci;
+	mChildren.insert( ci, node );
+
 	if( mOwner->getRoot() == node )
 		mOwner->setRoot((AnimationNode*)NULL);
 
 	if( mMainChild == NULL )
 		mMainChild = node;
+
+	mOwner->_invalidateProgram();
 }
 
 void AnimationNode::removeChild( unsigned short id )
@@ -106,10 +114,13 @@ void AnimationNode::removeChild( unsigned short id )
 
 		mChildrenById.erase(ci);
 		mChildrenByName.erase( node->getName() );
+		_eraseChild(node);
 		node->mParent = NULL;
 
 		if( mMainChild == node )
 			mMainChild = NULL;
+
+		mOwner->_invalidateProgram();
 	}
 }
 
@@ -128,10 +139,13 @@ void AnimationNode::removeChild( const std::string& name )
 
 		mChildrenById.erase( node->getId() );
 		mChildrenByName.erase(ci);
+		_eraseChild(node);
 		node->mParent = NULL;
 
 		if( mMainChild == node )
 			mMainChild = NULL;
+
+		mOwner->_invalidateProgram();
 	}
 }
 
@@ -141,15 +155,15 @@ void AnimationNode::removeAllChildren()
 			"Removing all children of node %s %u, %s.",
 			getClassName().c_str(), mId, mName.c_str() );
 
-	for( std::map<unsigned short, AnimationNode*>::iterator ci = mChildrenById.begin();
-		ci != mChildrenById.end(); ++ci )
-	{
-		ci->second->mParent = NULL;
-	}
+	for( unsigned int ci = 0; ci < mChildren.size(); ++ci )
+		mChildren[ci]->mParent = NULL;
 	
+	mChildren.clear();
 	mChildrenById.clear();
 	mChildrenByName.clear();
 	mMainChild = NULL;
+
+	mOwner->_invalidateProgram();
 }
 
 void AnimationNode::moveChild( unsigned short id, AnimationNode* node )
@@ -168,6 +182,7 @@ void AnimationNode::moveChild( unsigned short id, AnimationNode* node )
 
 	mChildrenByName.erase( cn->getName() );
 	mChildrenById.erase(ci);
+	_eraseChild(cn);
 	node->addChild(cn);
 
 	if( mMainChild == cn )
@@ -190,6 +205,7 @@ void AnimationNode::moveChild( const std::string& name, AnimationNode* node )
 
 	mChildrenById.erase( cn->getId() );
 	mChildrenByName.erase(ci);
+	_eraseChild(cn);
 	node->addChild(cn);
 
 	if( mMainChild == cn )
@@ -228,17 +244,17 @@ AnimationNode* AnimationNode::getChild( const std::string& name ) const
 
 unsigned int AnimationNode::getNumChildren() const
 {
-	return mChildrenById.size();
+	return mChildren.size();
 }
 
 AnimationNode::ChildIterator AnimationNode::getChildIterator()
 {
-	return ChildIterator( mChildrenById );
+	return ChildIterator( mChildren );
 }
 
 AnimationNode::ChildConstIterator AnimationNode::getChildConstIterator() const
 {
-	return ChildConstIterator( mChildrenById );
+	return ChildConstIterator( mChildren );
 }
 
 AnimationNode* AnimationNode::getMainChild() const
@@ -271,6 +287,7 @@ AnimationAdaptor* AnimationNode::createAdaptor( Skeleton* origSkel )
 {
 	deleteAdaptor();
 	mAnimAdaptor = new AnimationAdaptor( origSkel, this );
+	mOwner->_invalidateProgram();
 
 	return mAnimAdaptor;
 }
@@ -281,6 +298,7 @@ void AnimationNode::deleteAdaptor()
 	{
 		delete mAnimAdaptor;
 		mAnimAdaptor = NULL;
+		mOwner->_invalidateProgram();
 	}
 }
 
@@ -297,6 +315,7 @@ bool AnimationNode::getAdaptationEnabled() const
 void AnimationNode::setAdaptationEnabled( bool enabled )
 {
 	mAdaptEnabled = enabled;
+	mOwner->_invalidateProgram();
 }
 
 bool AnimationNode::getPlaying() const
@@ -444,24 +463,27 @@ void AnimationNode::setOrigin( const Skeleton::Situation& origin )
 void AnimationNode::maskBone( unsigned short boneId )
 {
 	mBoneMask.insert(boneId);
+	mOwner->_invalidateProgram();
 }
 
 void AnimationNode::unmaskBone( unsigned short boneId )
 {
 	mBoneMask.erase(boneId);
+	mOwner->_invalidateProgram();
 }
 
 void AnimationNode::unmaskAllBones()
 {
 	mBoneMask.clear();
+	mOwner->_invalidateProgram();
 }
 
 bool AnimationNode::isBoneMasked( unsigned short boneId )
 {
-	return mBoneMask.count(boneId) > 0;
+	return mBoneMask.isMasked(boneId);
 }
 
-const std::set<unsigned short>& AnimationNode::getBoneMask() const
+const BoneMask& AnimationNode::getBoneMask() const
 {
 	return mBoneMask;
 }
@@ -480,29 +502,31 @@ void AnimationNode::update( float dt )
 	_updateNode( dt * getPlayRate() );
 }
 
-void AnimationNode::apply( float weight, const std::set<unsigned short>& boneMask ) const
+void AnimationNode::apply( float weight, const BoneMask& boneMask ) const
 {
 	if( !mPlaying )
 		return;
 
 	// Compute merged bone mask
-	std::set<unsigned short> jmts;
-	std::set_union( boneMask.begin(), boneMask.end(),
-		mBoneMask.begin(), mBoneMask.end(),
-		std::inserter( jmts, jmts.begin() )
-		);
+	mMergedBoneMask.assign(boneMask);
+	mMergedBoneMask.unite(mBoneMask);
 
 	Skeleton* trg_skel = mOwner->_getCurrentSkeleton();
+	PoseAccumulator* trg_accum = mOwner->_getCurrentPoseAccumulator();
 	if( mAnimAdaptor != NULL && mAdaptEnabled )
 	{
+		// Retargetted motion is adapted straight onto the target skeleton,
+		// so it cannot take part in the enclosing pose blend
+		mOwner->_setCurrentPoseAccumulator(NULL);
+
 		// If we are retargetting motion, switch to the "original" skeleton
 		Skeleton* orig_skel = mAnimAdaptor->getOriginalSkeleton();
 		mOwner->_setCurrentSkeleton(orig_skel);
 		orig_skel->resetToInitialPose();
 	}
 
-	_applyNode( weight, jmts );
-	if( mAnnotsEnabled )
+	_applyNode( weight, mMergedBoneMask );
+	if( mAnnotsEnabled && mOwner->getAnnotationsEnabled() )
 		_applyAnnotations();
 
 	if( isLeaf() )
@@ -514,11 +538,17 @@ void AnimationNode::apply( float weight, const std::set<unsigned short>& boneMas
 		// If we are retargetting motion, we can now switch to
 		// "target" skeleton, and adapt the current pose
 		mOwner->_setCurrentSkeleton(trg_skel);
+		mOwner->_setCurrentPoseAccumulator(trg_accum);
 		if( mAnimAdaptor->getOriginalSkeleton() != trg_skel )
 			mAnimAdaptor->adapt(trg_skel);
 	}
 }
 
+void AnimationNode::apply( float weight, const std::set<unsigned short>& boneMask ) const
+{
+	apply( weight, BoneMask(boneMask) );
+}
+
 float AnimationNode::_getPrevTime() const
 {
 	return getPlayTime() - mDt;
@@ -556,7 +586,7 @@ void AnimationNode::_clone( AnimationNode* clonePtr, bool shareData ) const
 	clonePtr->mPlayRate = mPlayRate;
 
 	// clone bone mask
-	clonePtr->mBoneMask = mBoneMask;
+	clonePtr->mBoneMask.assign(mBoneMask);
 
 	// copy local annotations
 	mTransAnnots->_clone( clonePtr->mTransAnnots );
@@ -599,7 +629,7 @@ void AnimationNode::_updateNode( float dt )
 		ci.next()->update(dt);
 }
 
-void AnimationNode::_applyNode( float weight, const std::set<unsigned short>& boneMask ) const
+void AnimationNode::_applyNode( float weight, const BoneMask& boneMask ) const
 {
 	// apply child nodes
 	ChildConstIterator ci = getChildConstIterator();
@@ -607,14 +637,46 @@ void AnimationNode::_applyNode( float weight, const std::set<unsigned short>& bo
 		ci.next()->apply( weight, boneMask );
 }
 
+bool AnimationNode::_beginPoseBlend() const
+{
+	if( mOwner->_getCurrentPoseAccumulator() != NULL )
+		// already blending into an ancestor's accumulator
+		return false;
+
+	Skeleton* skel = mOwner->_getCurrentSkeleton();
+	if( !mPoseAccum.hasLayout(skel) )
+		mPoseAccum.init(skel);
+	else
+		mPoseAccum.reset();
+	mOwner->_setCurrentPoseAccumulator(&mPoseAccum);
+
+	return true;
+}
+
+void AnimationNode::_endPoseBlend() const
+{
+	zhAssert( mOwner->_getCurrentPoseAccumulator() == &mPoseAccum );
+
+	mOwner->_setCurrentPoseAccumulator(NULL);
+	Skeleton* skel = mOwner->_getCurrentSkeleton();
+	mPoseAccum.apply( skel, skel->getRoot()->getScale().y );
+}
+
+void AnimationNode::_eraseChild( AnimationNode* node )
+{
+	std::vector<AnimationNode*>::iterator ci = std::find( mChildren.begin(), mChildren.end(), node );
+	if( ci != mChildren.end() )
+		mChildren.erase(ci);
+}
+
 void AnimationNode::_applyAnnotations() const
 {
 	float time = getPlayTime(),
 		prev_time = _getPrevTime();
-	std::vector<AnimationAnnotation*> annots;
+	std::vector<AnimationAnnotation*>& annots = mAnnotBuffer;
 
 	// Find active annotations
-	getTransitionAnnotations()->getActiveAnnotations( prev_time, time, annots );
+	getTransitionAnnotations()->getActiveAnnotations( prev_time, time, annots, false, &mTransAnnotCursor );
 	for( unsigned int annot_i = 0; annot_i < annots.size(); ++annot_i )
 	{
 		TransitionAnnotation* annot = static_cast<TransitionAnnotation*>( annots[annot_i] );
@@ -626,7 +688,7 @@ void AnimationNode::_applyAnnotations() const
 
 	// Find finished annotations
 	annots.clear();
-	getTransitionAnnotations()->getFinishedAnnotations( prev_time, time, annots );
+	getTransitionAnnotations()->getFinishedAnnotations( prev_time, time, annots, true, &mTransAnnotCursor );
 	for( unsigned int annot_i = 0; annot_i < annots.size(); ++annot_i )
 	{
 		TransitionAnnotation* annot = static_cast<TransitionAnnotation*>( annots[annot_i] );
@@ -637,7 +699,7 @@ void AnimationNode::_applyAnnotations() const
 	}
 
 	// Find active annotations
-	getParamTransitionAnnotations()->getActiveAnnotations( prev_time, time, annots );
+	getParamTransitionAnnotations()->getActiveAnnotations( prev_time, time, annots, false, &mParamTransAnnotCursor );
 	for( unsigned int annot_i = 0; annot_i < annots.size(); ++annot_i )
 	{
 		ParamTransitionAnnotation* annot = static_cast<ParamTransitionAnnotation*>( annots[annot_i] );
@@ -649,7 +711,7 @@ void AnimationNode::_applyAnnotations() const
 
 	// Find finished annotations
 	annots.clear();
-	getParamTransitionAnnotations()->getFinishedAnnotations( prev_time, time, annots );
+	getParamTransitionAnnotations()->getFinishedAnnotations( prev_time, time, annots, true, &mParamTransAnnotCursor );
 	for( unsigned int annot_i = 0; annot_i < annots.size(); ++annot_i )
 	{
 		ParamTransitionAnnotation* annot = static_cast<ParamTransitionAnnotation*>( annots[annot_i] );
@@ -660,7 +722,7 @@ void AnimationNode::_applyAnnotations() const
 	}
 
 	// Find active annotations
-	getPlantConstraintAnnotations()->getActiveAnnotations( prev_time, time, annots );
+	getPlantConstraintAnnotations()->getActiveAnnotations( prev_time, time, annots, false, &mPlantConstrAnnotCursor );
 	for( unsigned int annot_i = 0; annot_i < annots.size(); ++annot_i )
 	{
 		PlantConstraintAnnotation* annot = static_cast<PlantConstraintAnnotation*>( annots[annot_i] );
@@ -672,7 +734,7 @@ void AnimationNode::_applyAnnotations() const
 
 	// Find finished annotations
 	annots.clear();
-	getPlantConstraintAnnotations()->getFinishedAnnotations( prev_time, time, annots );
+	getPlantConstraintAnnotations()->getFinishedAnnotations( prev_time, time, annots, true, &mPlantConstrAnnotCursor );
 	for( unsigned int annot_i = 0; annot_i < annots.size(); ++annot_i )
 	{
 		PlantConstraintAnnotation* annot = static_cast<PlantConstraintAnnotation*>( annots[annot_i] );
@@ -683,7 +745,7 @@ void AnimationNode::_applyAnnotations() const
 	}
 
 	// Find active annotations
-	getSimEventAnnotations()->getActiveAnnotations( prev_time, time, annots );
+	getSimEventAnnotations()->getActiveAnnotations( prev_time, time, annots, false, &mSimEventAnnotCursor );
 	for( unsigned int annot_i = 0; annot_i < annots.size(); ++annot_i )
 	{
 		SimEventAnnotation* annot = static_cast<SimEventAnnotation*>( annots[annot_i] );
@@ -695,7 +757,7 @@ void AnimationNode::_applyAnnotations() const
 
 	// Find finished annotations
 	annots.clear();
-	getSimEventAnnotations()->getFinishedAnnotations( prev_time, time, annots );
+	getSimEventAnnotations()->getFinishedAnnotations( prev_time, time, annots, true, &mSimEventAnnotCursor );
 	for( unsigned int annot_i = 0; annot_i < annots.size(); ++annot_i )
 	{
 		SimEventAnnotation* annot = static_cast<SimEventAnnotation*>( annots[annot_i] );
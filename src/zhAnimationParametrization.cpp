@@ -23,6 +23,7 @@ SOFTWARE.
 #include "zhAnimationParametrization.h"
 #include "zhString.h"
 #include "zhAnimationSpace.h"
+#include "zhScratchArena.h"
 
 namespace zh
 {
@@ -148,34 +149,37 @@ Vector DenseSamplingParametrization::sample( const Vector& paramValues ) const
 	// TODO: implement kd-tree search? using linear search for now
 
 	// compute Euclidean distance between each param. sample and specified param. vector
-	std::set<SortableSample> sorted_samples;
+	// (temporaries are drawn from the scratch arena during updates)
+	ScratchAllocator<SortableSample> alloc;
+	std::vector< SortableSample, ScratchAllocator<SortableSample> > sorted_samples(alloc);
+	sorted_samples.reserve( mSamples.size() );
 	for( unsigned int sample_i = 0; sample_i < mSamples.size(); ++sample_i )
-		sorted_samples.insert( SortableSample( sample_i, mSamples[sample_i].first.distanceSq(paramValues) ) );
+		sorted_samples.push_back( SortableSample( sample_i, mSamples[sample_i].first.distanceSq(paramValues) ) );
 
 	// get k nearest samples
-	std::vector<SortableSample> nearest_samples(zhAnimationParam_SampleInterpK);
-	unsigned int num_samples = 0;
-	for( std::set<SortableSample>::const_iterator sample_i = sorted_samples.begin();
-		sample_i != sorted_samples.end() && num_samples < zhAnimationParam_SampleInterpK;
-		++sample_i, ++num_samples )
-	{
-		nearest_samples[num_samples] = *sample_i;
-	}
+	unsigned int num_samples = std::min<unsigned int>( zhAnimationParam_SampleInterpK, sorted_samples.size() );
+	std::partial_sort( sorted_samples.begin(), sorted_samples.begin() + num_samples, sorted_samples.end() );
+	const SortableSample* nearest_samples = num_samples > 0 ? &sorted_samples[0] : NULL;
 
 	// compute interpolation weights
-	Vector knn_weights( num_samples );
+	std::vector< float, ScratchAllocator<float> > knn_weights( num_samples, 0.f, alloc );
 	float inv_maxdist = 1.f / sqrt( nearest_samples[ num_samples - 1 ].dist ); // TODO: how about an efficient InvSqrt impl.? there is a nice one in id Tech 3
+	float knn_wsum = 0;
 	for( unsigned int sample_i = 0; sample_i < num_samples; ++sample_i )
 	{
 		knn_weights[sample_i] = 1.f / sqrt( nearest_samples[sample_i].dist ) - inv_maxdist;
+		knn_wsum += knn_weights[sample_i];
 	}
-	knn_weights = knn_weights / knn_weights.sum();
 
 	// interpolate k nearest samples
 	Vector weights( getNumBaseSamples() ); // interpolated blend weights
 	for( unsigned int sample_i = 0; sample_i < num_samples; ++sample_i )
 	{
-		weights += mSamples[ nearest_samples[sample_i].sampleIndex ].second * knn_weights[sample_i];
+		const Vector& sample_weights = mSamples[ nearest_samples[sample_i].sampleIndex ].second;
+		float knn_w = knn_weights[sample_i] / knn_wsum;
+
+		for( unsigned int wi = 0; wi < weights.size(); ++wi )
+			weights[wi] += sample_weights[wi] * knn_w;
 	}
 
 	return weights;
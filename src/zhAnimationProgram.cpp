@@ -0,0 +1,355 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhAnimationProgram.h"
+#include "zhAnimationTree.h"
+
+namespace zh
+{
+
+AnimationProgram::AnimationProgram()
+: mCompiled(false), mSupported(false), mMaxDepth(0)
+{
+}
+
+AnimationProgram::~AnimationProgram()
+{
+}
+
+bool AnimationProgram::compile( const AnimationTree* tree )
+{
+	zhAssert( tree != NULL );
+
+	mInstructions.clear();
+	mBoneMasks.clear();
+	mQueueGuards.clear();
+	mMaxDepth = 0;
+
+	AnimationNode* root = tree->getRoot();
+	mCompiled = true;
+	mSupported = root == NULL ||
+		_compileNode( root, NULL, WeightSource_Parent, 0, Animation::EmptyBoneMask, 1 );
+
+	if( !mSupported )
+	{
+		// keep queue guards, so the tree isn't recompiled every frame
+		mInstructions.clear();
+		mBoneMasks.clear();
+	}
+
+	mWeightStack.resize( mMaxDepth + 1 );
+
+	return mSupported;
+}
+
+void AnimationProgram::invalidate()
+{
+	mCompiled = false;
+}
+
+bool AnimationProgram::isValid() const
+{
+	if( !mCompiled )
+		return false;
+
+	for( unsigned int gi = 0; gi < mQueueGuards.size(); ++gi )
+	{
+		const QueueGuard& guard = mQueueGuards[gi];
+		if( guard.node->getCurrentNode() != guard.currentNode ||
+			guard.node->getNextNode() != guard.nextNode )
+			return false;
+	}
+
+	return true;
+}
+
+bool AnimationProgram::isSupported() const
+{
+	return mSupported;
+}
+
+unsigned int AnimationProgram::getNumInstructions() const
+{
+	return mInstructions.size();
+}
+
+const AnimationProgram::Instruction& AnimationProgram::getInstruction( unsigned int index ) const
+{
+	zhAssert( index < mInstructions.size() );
+
+	return mInstructions[index];
+}
+
+void AnimationProgram::run( AnimationTree* tree, const BoneMask& boneMask )
+{
+	zhAssert( tree != NULL );
+	zhAssert( mCompiled && mSupported );
+
+	if( mInstructions.empty() )
+		return;
+
+	Skeleton* skel = tree->_getCurrentSkeleton();
+	bool annots_enabled = tree->getAnnotationsEnabled();
+
+	bool blend = _needsPoseBlend();
+	if(blend)
+	{
+		if( !mPoseAccum.hasLayout(skel) )
+			mPoseAccum.init(skel);
+		else
+			mPoseAccum.reset();
+		tree->_setCurrentPoseAccumulator(&mPoseAccum);
+	}
+
+	unsigned int sp = 0;
+	mWeightStack[0] = 1;
+
+	unsigned int pc = 0;
+	while( pc < mInstructions.size() )
+	{
+		const Instruction& instr = mInstructions[pc];
+
+		switch( instr.opcode )
+		{
+
+		case Opcode_Enter:
+		{
+			float weight;
+			if( !_getEnterWeight( instr, mWeightStack[sp], weight ) )
+			{
+				pc = instr.jump;
+				continue;
+			}
+
+			mWeightStack[++sp] = weight;
+			break;
+		}
+
+		case Opcode_Sample:
+		{
+			const BoneMask* bone_mask = &mBoneMasks[instr.arg];
+			if( !boneMask.empty() )
+			{
+				mMergedBoneMask.assign(*bone_mask);
+				mMergedBoneMask.unite(boneMask);
+				bone_mask = &mMergedBoneMask;
+			}
+
+			instr.node->_applyNode( mWeightStack[sp], *bone_mask );
+			break;
+		}
+
+		case Opcode_EmitTransitionEvents:
+		{
+			static_cast<const AnimationQueueNode*>( instr.node )->_emitTransitionEvents();
+			break;
+		}
+
+		case Opcode_Exit:
+		{
+			if( annots_enabled && instr.node->getAnnotationsEnabled() )
+				instr.node->_applyAnnotations();
+
+			if( instr.arg > 0 )
+				// update cumulative blend weight
+				tree->_setTotalWeight( tree->_getTotalWeight() + mWeightStack[sp] );
+
+			--sp;
+			break;
+		}
+
+		}
+
+		++pc;
+	}
+
+	if(blend)
+	{
+		tree->_setCurrentPoseAccumulator(NULL);
+		mPoseAccum.apply( skel, skel->getRoot()->getScale().y );
+	}
+}
+
+bool AnimationProgram::_getEnterWeight( const Instruction& instr, float parentWeight, float& weight ) const
+{
+	if( !instr.node->getPlaying() )
+		return false;
+
+	weight = parentWeight;
+	if( instr.weightSource == WeightSource_BlendChild )
+	{
+		float child_weight = static_cast<const AnimationBlendNode*>( instr.weightNode )->getWeights()[instr.arg];
+		if( zhEqualf( child_weight, 0 ) )
+			return false;
+
+		weight *= child_weight;
+	}
+	else if( instr.weightSource == WeightSource_QueueCurrent )
+	{
+		weight *= static_cast<const AnimationQueueNode*>( instr.weightNode )->getCurrentWeight();
+	}
+	else if( instr.weightSource == WeightSource_QueueNext )
+	{
+		weight *= static_cast<const AnimationQueueNode*>( instr.weightNode )->getNextWeight();
+	}
+
+	return true;
+}
+
+bool AnimationProgram::_needsPoseBlend()
+{
+	// blend leaf poses, unless a single leaf is applied with full weight
+	// (same rule as AnimationBlendNode::_applyNode())
+	unsigned int num_active = 0;
+	float active_weight = 0;
+
+	unsigned int sp = 0;
+	mWeightStack[0] = 1;
+
+	unsigned int pc = 0;
+	while( pc < mInstructions.size() )
+	{
+		const Instruction& instr = mInstructions[pc];
+
+		if( instr.opcode == Opcode_Enter )
+		{
+			float weight;
+			if( !_getEnterWeight( instr, mWeightStack[sp], weight ) )
+			{
+				pc = instr.jump;
+				continue;
+			}
+
+			mWeightStack[++sp] = weight;
+		}
+		else if( instr.opcode == Opcode_Sample )
+		{
+			if( ++num_active > 1 )
+				return true;
+
+			active_weight = mWeightStack[sp];
+		}
+		else if( instr.opcode == Opcode_Exit )
+		{
+			--sp;
+		}
+
+		++pc;
+	}
+
+	return num_active == 1 && !zhEqualf( active_weight, 1 );
+}
+
+bool AnimationProgram::_compileNode( const AnimationNode* node, const AnimationNode* weightNode,
+									WeightSource weightSrc, unsigned int weightIndex,
+									const BoneMask& boneMask, unsigned int depth )
+{
+	if( node->getAdaptor() != NULL && node->getAdaptationEnabled() )
+		// retargetting switches skeletons mid-tree, not supported
+		return false;
+
+	// merge bone mask with the parent's mask
+	BoneMask bone_mask(boneMask);
+	bone_mask.unite( node->getBoneMask() );
+
+	if( depth > mMaxDepth )
+		mMaxDepth = depth;
+
+	unsigned int enter_i = mInstructions.size();
+	_emit( Opcode_Enter, node, weightNode, weightSrc, weightIndex );
+
+	if( node->isClass( AnimationSampleNode::ClassId() ) )
+	{
+		mBoneMasks.push_back(bone_mask);
+		_emit( Opcode_Sample, node, NULL, WeightSource_Parent, mBoneMasks.size() - 1 );
+	}
+	else if( node->isClass( AnimationBlendNode::ClassId() ) )
+	{
+		const AnimationBlendNode* bnode = static_cast<const AnimationBlendNode*>(node);
+
+		AnimationNode::ChildConstIterator child_i = bnode->getChildConstIterator();
+		while( !child_i.end() )
+		{
+			AnimationNode* child = child_i.next();
+			unsigned int banim_i = bnode->_getBaseAnimationIndex( child->getId() );
+
+			if( !_compileNode( child, bnode, WeightSource_BlendChild, banim_i, bone_mask, depth + 1 ) )
+				return false;
+		}
+	}
+	else if( node->isClass( AnimationQueueNode::ClassId() ) )
+	{
+		const AnimationQueueNode* qnode = static_cast<const AnimationQueueNode*>(node);
+		AnimationNode* cur_node = qnode->getCurrentNode();
+		AnimationNode* next_node = qnode->getNextNode();
+
+		QueueGuard guard;
+		guard.node = qnode;
+		guard.currentNode = cur_node;
+		guard.nextNode = next_node;
+		mQueueGuards.push_back(guard);
+
+		if( cur_node != NULL && next_node == NULL )
+		{
+			if( !_compileNode( cur_node, qnode, WeightSource_Parent, 0, bone_mask, depth + 1 ) )
+				return false;
+		}
+		else if( cur_node != NULL )
+		{
+			if( cur_node == next_node )
+				// node is applied twice with different playback states, not supported
+				return false;
+
+			if( !_compileNode( cur_node, qnode, WeightSource_QueueCurrent, 0, bone_mask, depth + 1 ) ||
+				!_compileNode( next_node, qnode, WeightSource_QueueNext, 0, bone_mask, depth + 1 ) )
+				return false;
+
+			_emit( Opcode_EmitTransitionEvents, node );
+		}
+	}
+	else
+	{
+		// unknown node class
+		return false;
+	}
+
+	_emit( Opcode_Exit, node, NULL, WeightSource_Parent, node->isLeaf() ? 1 : 0 );
+	mInstructions[enter_i].jump = mInstructions.size();
+
+	return true;
+}
+
+void AnimationProgram::_emit( Opcode opcode, const AnimationNode* node, const AnimationNode* weightNode,
+							 WeightSource weightSrc, unsigned int arg )
+{
+	Instruction instr;
+	instr.opcode = opcode;
+	instr.node = node;
+	instr.weightNode = weightNode;
+	instr.weightSource = weightSrc;
+	instr.arg = arg;
+	instr.jump = 0;
+
+	mInstructions.push_back(instr);
+}
+
+}
@@ -577,7 +577,7 @@ void AnimationQueueNode::_updateNode( float dt )
 	}
 }
 
-void AnimationQueueNode::_applyNode( float weight, const std::set<unsigned short>& boneMask ) const
+void AnimationQueueNode::_applyNode( float weight, const BoneMask& boneMask ) const
 {
 	if( mCurrentNode == NULL )
 		// no animations are scheduled, nothing to do here
@@ -597,6 +597,9 @@ void AnimationQueueNode::_applyNode( float weight, const std::set<unsigned short
 		if( mNextNode->isClass( AnimationBlendNode::ClassId() ) )
 			next_pnode = static_cast<AnimationBlendNode*>(mNextNode);
 
+		// blend both animations in a pose accumulator
+		bool blend = _beginPoseBlend();
+
 		// apply current anim.
 		mCurrentNode->apply( weight * mWeight, boneMask );
 
@@ -622,6 +625,9 @@ void AnimationQueueNode::_applyNode( float weight, const std::set<unsigned short
 		// apply next anim.
 		mNextNode->apply( weight * ( 1.f - mWeight ), boneMask );
 
+		if(blend)
+			_endPoseBlend();
+
 		if( mCurrentNode == mNextNode )
 		{
 			// next anim. same as current anim.,
@@ -632,23 +638,28 @@ void AnimationQueueNode::_applyNode( float weight, const std::set<unsigned short
 				next_pnode->setParams(cparams);
 		}
 
-		// notify listeners of transition start
-		if(mTransStarted)
-		{
-			AnimationQueueNodeEvent evt( const_cast<AnimationQueueNode*>(this), false );
-			evt.emit();
-			
-			mTransStarted = false;
-		}
+		_emitTransitionEvents();
+	}
+}
 
-		// notify listeners of transition end
-		if(mTransFinished)
-		{
-			AnimationQueueNodeEvent evt( const_cast<AnimationQueueNode*>(this), true );
-			evt.emit();
-			
-			mTransFinished = false;
-		}
+void AnimationQueueNode::_emitTransitionEvents() const
+{
+	// notify listeners of transition start
+	if(mTransStarted)
+	{
+		AnimationQueueNodeEvent evt( const_cast<AnimationQueueNode*>(this), false );
+		evt.emit();
+		
+		mTransStarted = false;
+	}
+
+	// notify listeners of transition end
+	if(mTransFinished)
+	{
+		AnimationQueueNodeEvent evt( const_cast<AnimationQueueNode*>(this), true );
+		evt.emit();
+		
+		mTransFinished = false;
 	}
 }
 
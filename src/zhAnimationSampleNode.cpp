@@ -26,7 +26,7 @@ namespace zh
 {
 
 AnimationSampleNode::AnimationSampleNode()
-: mAnimSet(NULL), mAnimId(0), mPlayTime(0)
+: mAnimSet(NULL), mAnimId(0), mPlayTime(0), mOriginOrientY(0), mOriginOnGround(true)
 {
 }
 
@@ -119,6 +119,12 @@ const Skeleton::Situation& AnimationSampleNode::getOrigin() const
 void AnimationSampleNode::setOrigin( const Skeleton::Situation& origin )
 {
 	mOrigin = origin;
+
+	// origins are usually ground-plane transformations,
+	// in which case the mover heading can be composed directly
+	mOriginOrientY = origin.getOrientY();
+	mOriginOnGround = zhEqualf( fabs( origin.getOrientation().dot(
+		Quat( Vector3::YAxis, mOriginOrientY ) ) ), 1.f );
 }
 
 AnimationSetPtr AnimationSampleNode::getAnimationSet() const
@@ -145,6 +151,7 @@ void AnimationSampleNode::setAnimation( AnimationSetPtr animSet, unsigned short
 
 	mAnimSet = animSet;
 	mAnimId = animId;
+	mKFCursor = KeyFrameCursor();
 }
 
 Skeleton::Situation AnimationSampleNode::_sampleMover() const
@@ -156,15 +163,45 @@ Skeleton::Situation AnimationSampleNode::_sampleMover() const
 
 	Skeleton* skel = mOwner->_getCurrentSkeleton();
 	Bone* root = skel->getRoot();
-
-	// sample anim. mover
 	Vector3 ipos = root->getInitialPosition();
 	Quat iorient = root->getInitialOrientation();
+
+	const MoverCurve* mvc = anim->getMoverCurve();
+	if( mvc != NULL && mvc->getBoneId() == root->getId() && iorient == Quat::Identity )
+	{
+		// sample precomputed mover
+		Vector3 pos;
+		Quat orient;
+		mvc->sample( mPlayTime, pos, orient );
+		pos += ipos;
+
+		// realign mover, keeping vertical translation and rotation
+		Vector3 rpos = mOrigin.getPosition() + pos.getRotated( mOrigin.getOrientation() );
+		pos.x = rpos.x;
+		pos.z = rpos.z;
+		if( mOriginOnGround )
+		{
+			// heading rotation composes with the mover heading (YXZ order)
+			orient = mOrigin.getOrientation() * orient;
+		}
+		else
+		{
+			float ax, ay, az, rax, raz;
+			orient.getEuler( ax, ay, az );
+			( mOrigin.getOrientation() * orient ).getEuler( rax, ay, raz );
+			orient = Quat( ax, ay, az );
+		}
+
+		return Skeleton::Situation( pos, orient );
+	}
+
+	// sample anim. mover
 	BoneAnimationTrack* rbat = anim->getBoneTrack( root->getId() );
-	TransformKeyFrame tkf( 0, 0 );
-	rbat->getInterpolatedKeyFrame( mPlayTime, &tkf );
-	Vector3 pos = ipos + tkf.getTranslation();
-	Quat orient = iorient * tkf.getRotation();
+	Vector3 trans, scal;
+	Quat rot;
+	rbat->getInterpolatedTransform( mPlayTime, trans, rot, scal, &mKFCursor );
+	Vector3 pos = ipos + trans;
+	Quat orient = iorient * rot;
 	Skeleton::Situation mv( pos, orient );
 
 	// realign mover
@@ -197,6 +234,8 @@ void AnimationSampleNode::_clone( AnimationNode* clonePtr, bool shareData ) cons
 
 	clone->mPlayTime = mPlayTime;
 	clone->mOrigin = mOrigin;
+	clone->mOriginOrientY = mOriginOrientY;
+	clone->mOriginOnGround = mOriginOnGround;
 
 	clone->mAnimSet = mAnimSet;
 	clone->mAnimId = mAnimId;
@@ -214,7 +253,7 @@ void AnimationSampleNode::_updateNode( float dt )
 		mPlayTime -= floor(mPlayTime/length) * length;
 }
 
-void AnimationSampleNode::_applyNode( float weight, const std::set<unsigned short>& boneMask ) const
+void AnimationSampleNode::_applyNode( float weight, const BoneMask& boneMask ) const
 {
 	Animation* anim = getAnimation();
 
@@ -225,7 +264,7 @@ void AnimationSampleNode::_applyNode( float weight, const std::set<unsigned shor
 	Bone* root = skel->getRoot();
 	float scale = root->getScale().y;
 
-	std::set<unsigned short> bone_mask = boneMask;
+	const BoneMask* bone_mask = &boneMask;
 
 	if( mOwner->getApplyMover() )
 	{
@@ -242,11 +281,23 @@ void AnimationSampleNode::_applyNode( float weight, const std::set<unsigned shor
 			weight / ( mOwner->_getTotalWeight() + weight ) ) );
 
 		// mover applied separately, so mask root bone
-		bone_mask.insert( root->getId() );
+		mMoverBoneMask.assign(boneMask);
+		mMoverBoneMask.insert( root->getId() );
+		bone_mask = &mMoverBoneMask;
 	}
 
-	// apply animation
-	anim->apply( skel, mPlayTime, weight, scale, bone_mask );
+	// sample animation into pose buffer, then apply it
+	if( !mPose.hasLayout(skel) )
+		mPose.init(skel);
+	else
+		mPose.reset();
+	anim->sample( mPlayTime, mPose, *bone_mask, &mKFCursor );
+	PoseAccumulator* pose_accum = mOwner->_getCurrentPoseAccumulator();
+	if( pose_accum != NULL )
+		// we're inside a blend, leave it to the blending node to apply the pose
+		pose_accum->accumulate( mPose, weight, *bone_mask );
+	else
+		mPose.apply( skel, weight, scale );
 }
 
 }
@@ -112,6 +112,7 @@ const CatmullRomSpline<Vector>& AnimationSpace::getTimewarpCurve() const
 void AnimationSpace::setTimewarpCurve( const CatmullRomSpline<Vector>& curve )
 {
 	mTWCurve = curve;
+	mTWCurve.setBakeCoefficients();
 	mTWCurve.calcTangents();
 }
 
@@ -128,6 +129,7 @@ const CatmullRomSpline<Vector>& AnimationSpace::getAlignmentCurve() const
 void AnimationSpace::setAlignmentCurve( const CatmullRomSpline<Vector>& curve )
 {
 	mAlignCurve = curve;
+	mAlignCurve.setBakeCoefficients();
 	mAlignCurve.calcTangents();
 }
 
@@ -129,6 +129,7 @@ void AnimationSpaceBuilder::build( MatchGraph* matches, unsigned short refNodeHa
 				btkf->setScale( tkf->getScale() );
 			}
 		}
+		banim->buildInterpSplines();
 
 		// recreate annotations on base anims
 		//_copyAnnotsToBaseAnim( anim_seg, anim_seg.getAnimation()->getTransitionAnnotations(), banim->getTransitionAnnotations() );
@@ -39,13 +39,14 @@ SOFTWARE.
 namespace zh
 {
 
-AnimationSystem::AnimationSystem() : mOutSkel(NULL)
+AnimationSystem::AnimationSystem() : mOutSkel(NULL), mEventsDeferred(false)
 {
 	mAnimTree = new AnimationTree("MainTree");
 }
 
 AnimationSystem::~AnimationSystem()
 {
+	deleteAllCharacters();
 	delete mAnimTree;
 }
 
@@ -377,19 +378,18 @@ Animation* AnimationSystem::createAnimationFromSegment( const std::string& newAn
 		// copy intervening key-frames
 		for( unsigned int kfi = 0; kfi < rbat->getNumKeyFrames(); ++kfi )
 		{
-			zh::TransformKeyFrame* rtkf = static_cast<zh::TransformKeyFrame*>( rbat->getKeyFrame(kfi) );
+			float kft = rbat->getKeyFrameTime(kfi);
 			
-			if( rtkf->getTime() <= startTime )
+			if( kft <= startTime )
 				continue;
-			if( rtkf->getTime() >= startTime+length )
+			if( kft >= startTime+length )
 				break;
 
-			tkf = static_cast<zh::TransformKeyFrame*>( bat->createKeyFrame( rtkf->getTime() - startTime ) );
-			tkf->setTranslation( rtkf->getTranslation() );
-			tkf->setRotation( rtkf->getRotation() );
-			tkf->setScale( rtkf->getScale() );
+			bat->createTransformKeyFrame( kft - startTime, rbat->getKeyFrameTranslation(kfi),
+				rbat->getKeyFrameRotation(kfi), rbat->getKeyFrameScale(kfi) );
 		}
 	}
+	anim->buildInterpSplines();
 
 	// Add the new animation to the animation tree
 	AnimationSampleNode* node = static_cast<AnimationSampleNode*>(
@@ -608,8 +608,32 @@ void AnimationSystem::update( float dt ) const
 	if( mOutSkel == NULL )
 		return;
 
+	bool defer = mEventsDeferred && EventQueue::GetDeferredQueue() == NULL;
+	if(defer)
+		EventQueue::SetDeferredQueue(&mEventQueue);
+	bool use_arena = ScratchArena::GetCurrent() == NULL;
+	if(use_arena)
+		ScratchArena::SetCurrent(&mScratchArena);
+
 	mAnimTree->update(dt);
 	mAnimTree->apply(mOutSkel);
+	mOutSkel->updateWorldTransforms();
+
+	if(use_arena)
+	{
+		ScratchArena::SetCurrent(NULL);
+#if zhAllocTracking_Enabled
+		if( mScratchArena.getNumHeapAllocs() > 0 )
+			zhLog( "AnimationSystem", "update",
+				"%u heap allocations made during update.", mScratchArena.getNumHeapAllocs() );
+#endif
+		mScratchArena.reset();
+	}
+	if(defer)
+	{
+		EventQueue::SetDeferredQueue(NULL);
+		mEventQueue.flush();
+	}
 }
 
 AnimationTree* AnimationSystem::getAnimationTree() const
@@ -617,6 +641,189 @@ AnimationTree* AnimationSystem::getAnimationTree() const
 	return mAnimTree;
 }
 
+Character* AnimationSystem::createCharacter( const std::string& name, const std::string& skelName,
+	const AnimationTree* animTree )
+{
+	zhAssert( !hasCharacter(name) );
+	zhAssert( hasSkeleton(skelName) );
+
+	zhLog( "AnimationSystem", "createCharacter",
+		"Creating character %s with skeleton %s.", name.c_str(), skelName.c_str() );
+
+	if( animTree == NULL )
+		animTree = mAnimTree;
+
+	// create character's own skeleton and animation tree
+	Skeleton* skel = new Skeleton(name);
+	getSkeleton(skelName)->_clone(skel);
+	AnimationTree* tree = new AnimationTree(name);
+	animTree->_clone(tree);
+
+	Character* chr = new Character( name, skel, tree );
+	chr->setLODPolicy(&mLODPolicy);
+	mCharacters.push_back(chr);
+	mCharactersByName[name] = chr;
+
+	return chr;
+}
+
+void AnimationSystem::deleteCharacter( const std::string& name )
+{
+	zhLog( "AnimationSystem", "deleteCharacter", "Deleting character %s.", name.c_str() );
+
+	Character* chr = getCharacter(name);
+
+	if( chr == NULL )
+		return;
+
+	mCharactersByName.erase(name);
+	mCharacters.erase( std::find( mCharacters.begin(), mCharacters.end(), chr ) );
+	delete chr;
+}
+
+void AnimationSystem::deleteAllCharacters()
+{
+	for( unsigned int chri = 0; chri < mCharacters.size(); ++chri )
+		delete mCharacters[chri];
+
+	mCharacters.clear();
+	mCharactersByName.clear();
+}
+
+bool AnimationSystem::hasCharacter( const std::string& name ) const
+{
+	return mCharactersByName.count(name) > 0;
+}
+
+Character* AnimationSystem::getCharacter( const std::string& name ) const
+{
+	std::map<std::string, Character*>::const_iterator ci = mCharactersByName.find(name);
+
+	if( ci != mCharactersByName.end() )
+		return ci->second;
+
+	return NULL;
+}
+
+AnimationSystem::CharacterIterator AnimationSystem::getCharacterIterator()
+{
+	return CharacterIterator( mCharacters );
+}
+
+AnimationSystem::CharacterConstIterator AnimationSystem::getCharacterConstIterator() const
+{
+	return CharacterConstIterator( mCharacters );
+}
+
+unsigned int AnimationSystem::getNumCharacters() const
+{
+	return mCharacters.size();
+}
+
+/**
+* @brief Task which updates a single character.
+*/
+class CharacterUpdateTask : public ThreadPool::Task
+{
+
+public:
+
+	CharacterUpdateTask( const std::vector<Character*>& chars, float dt, bool deferEvents )
+		: mChars(chars), mDt(dt), mDeferEvents(deferEvents)
+	{
+	}
+
+	void operator()( unsigned int chrIndex )
+	{
+		Character* chr = mChars[chrIndex];
+
+		// each character defers its events into its own queue,
+		// so they can be delivered in the order of characters
+		EventQueue* prev_queue = EventQueue::GetDeferredQueue();
+		if(mDeferEvents)
+			EventQueue::SetDeferredQueue( &chr->_getEventQueue() );
+
+		chr->update(mDt);
+
+		if(mDeferEvents)
+			EventQueue::SetDeferredQueue(prev_queue);
+	}
+
+	void call( unsigned int chrIndex )
+	{
+		(*this)(chrIndex);
+	}
+
+private:
+
+	const std::vector<Character*>& mChars;
+	float mDt;
+	bool mDeferEvents;
+
+};
+
+void AnimationSystem::updateAll( float dt )
+{
+	// listeners aren't thread-safe, so events emitted on worker threads
+	// are always deferred and delivered here
+	EventQueue* outer_queue = EventQueue::GetDeferredQueue();
+	bool defer = ( mEventsDeferred || mThreadPool.getNumWorkers() > 1 ) &&
+		outer_queue == NULL;
+	if(defer)
+		EventQueue::SetDeferredQueue(&mEventQueue);
+
+	update(dt);
+
+	// character events are deferred into per-character queues,
+	// which are flushed in the order of characters, regardless
+	// of which threads updated them
+	bool defer_chars = defer || outer_queue != NULL;
+	CharacterUpdateTask task( mCharacters, dt, defer_chars );
+	mThreadPool.run( mCharacters.size(), task );
+
+	if(defer)
+	{
+		EventQueue::SetDeferredQueue(NULL);
+		mEventQueue.flush();
+	}
+	if(defer_chars)
+	{
+		// if an outer queue is set, flushed events are moved into it
+		for( unsigned int chri = 0; chri < mCharacters.size(); ++chri )
+			mCharacters[chri]->_getEventQueue().flush();
+	}
+}
+
+bool AnimationSystem::getEventsDeferred() const
+{
+	return mEventsDeferred;
+}
+
+void AnimationSystem::setEventsDeferred( bool deferred )
+{
+	mEventsDeferred = deferred;
+}
+
+unsigned int AnimationSystem::getNumWorkerThreads() const
+{
+	return mThreadPool.getNumWorkers();
+}
+
+void AnimationSystem::setNumWorkerThreads( unsigned int numThreads )
+{
+	mThreadPool.setNumWorkers(numThreads);
+}
+
+LODPolicy& AnimationSystem::getLODPolicy()
+{
+	return mLODPolicy;
+}
+
+const LODPolicy& AnimationSystem::getLODPolicy() const
+{
+	return mLODPolicy;
+}
+
 AnimationSystem::AnimationNodeFactory& AnimationSystem::_getAnimationNodeFactory()
 {
 	return mAnimNodeFact;
@@ -632,6 +839,11 @@ MemoryPool* AnimationSystem::_getMemoryPool() const
 	return MemoryPool::Instance();
 }
 
+EventQueue& AnimationSystem::_getEventQueue() const
+{
+	return mEventQueue;
+}
+
 void AnimationSystem::ParseAnimationName( const std::string& fullName,
 	std::string& animSetName, std::string& animName )
 {
@@ -66,6 +66,7 @@ bool KeyFrameCompare::operator()( float t1, const KeyFrame* kf2 )
 }
 
 AnimationTrack::AnimationTrack( Animation* anim )
+: mKeySpacing(0), mInvKeySpacing(0)
 {
 	zhAssert( anim != NULL );
 
@@ -74,7 +75,7 @@ AnimationTrack::AnimationTrack( Animation* anim )
 
 AnimationTrack::~AnimationTrack()
 {
-	deleteAllKeyFrames();
+	_destroyKeyFrames();
 }
 
 Animation* AnimationTrack::getAnimation() const
@@ -84,103 +85,134 @@ Animation* AnimationTrack::getAnimation() const
 
 KeyFrame* AnimationTrack::createKeyFrame( float time )
 {
-	KeyFrame* kf = NULL;
+	unsigned int kfi = _insertKeyFrame(time);
+	_createKeyFrameViews();
 
-	for( std::vector<KeyFrame*>::iterator kfi = mKeyFrames.begin();
-		kfi != mKeyFrames.end(); ++kfi )
-	{
-		if( zhEqualf( (*kfi)->getTime(), time ) )
-		{
-			kf = *kfi;
-			break;
-		}
-		else if( (*kfi)->getTime() > time )
-		{
-			kf = _createKeyFrame(time);
-			mKeyFrames.insert( kfi, kf );
-			break;
-		}
-	}
-
-	if( kf == NULL )
-	{
-		kf = _createKeyFrame(time);
-		mKeyFrames.push_back(kf);
-	}
-
-	_updateKeyFrameIndices();
-
-	return kf;
+	return mKeyFrames[kfi];
 }
 
 void AnimationTrack::deleteKeyFrame( unsigned int index )
 {
 	zhAssert( index < getNumKeyFrames() );
 
-	delete mKeyFrames[index];
-	mKeyFrames.erase( mKeyFrames.begin() + index );
+	if( !mKeyFrames.empty() )
+	{
+		delete mKeyFrames[index];
+		mKeyFrames.erase( mKeyFrames.begin() + index );
+	}
+	mKeyTimes.erase( mKeyTimes.begin() + index );
+	_deleteKeyFrameData(index);
 
 	_updateKeyFrameIndices();
+	_updateKeyFrameSpacing();
 }
 
 void AnimationTrack::deleteAllKeyFrames()
 {
-	for( unsigned int kfi = 0; kfi < mKeyFrames.size(); ++kfi )
-		delete mKeyFrames[kfi];
-
-	mKeyFrames.clear();
+	_destroyKeyFrames();
+	_deleteAllKeyFrameData();
 }
 
 KeyFrame* AnimationTrack::getKeyFrame( unsigned int index ) const
 {
 	zhAssert( index < getNumKeyFrames() );
 
+	_createKeyFrameViews();
 	return mKeyFrames[index];
 }
 
 unsigned int AnimationTrack::getNumKeyFrames() const
 {
-	return mKeyFrames.size();
+	return mKeyTimes.size();
+}
+
+float AnimationTrack::getKeyFrameTime( unsigned int index ) const
+{
+	zhAssert( index < getNumKeyFrames() );
+
+	return mKeyTimes[index];
 }
 
 AnimationTrack::KeyFrameIterator AnimationTrack::getKeyFrameIterator()
 {
+	_createKeyFrameViews();
 	return KeyFrameIterator( mKeyFrames );
 }
 
 AnimationTrack::KeyFrameConstIterator AnimationTrack::getKeyFrameConstIterator() const
 {
+	_createKeyFrameViews();
 	return KeyFrameConstIterator( mKeyFrames );
 }
 
 float AnimationTrack::getKeyFramesAtTime( float time, KeyFrame** kf1, KeyFrame** kf2 ) const
 {
-	float t = 0;
 	*kf1 = *kf2 = NULL;
 
-	if( mKeyFrames.size() == 0 )
+	if( mKeyTimes.size() == 0 )
 		return 0;
 
-	KeyFrameCompare kfc;
-	std::vector<KeyFrame*>::const_iterator kfi =
-		upper_bound( mKeyFrames.begin(), mKeyFrames.end(), time, kfc );
+	unsigned int kfi1, kfi2;
+	float t = getKeyFrameIndicesAtTime( time, kfi1, kfi2 );
+	_createKeyFrameViews();
+	*kf1 = mKeyFrames[kfi1];
+	*kf2 = mKeyFrames[kfi2];
+
+	return t;
+}
 
-	if( kfi == mKeyFrames.begin() )
+float AnimationTrack::getKeyFrameIndicesAtTime( float time, unsigned int& kfi1, unsigned int& kfi2,
+											   KeyFrameCursor* cursor ) const
+{
+	zhAssert( mKeyTimes.size() > 0 );
+
+	// max. number of key-frames we step over before giving up on the cursor
+	static const unsigned int max_steps = 4;
+
+	unsigned int last_kfi = mKeyTimes.size() - 1;
+
+	if( time < mKeyTimes[0] )
 	{
-		*kf1 = *kf2 = *kfi;
+		kfi1 = kfi2 = 0;
 	}
-	else if( kfi == mKeyFrames.end() )
+	else if( time >= mKeyTimes[last_kfi] )
 	{
-		*kf1 = *kf2 = *( kfi - 1 );
+		kfi1 = kfi2 = last_kfi;
 	}
 	else
 	{
-		*kf1 = *( kfi - 1 );
-		*kf2 = *kfi;
-		t = ( time - (*kf1)->getTime() ) / ( (*kf2)->getTime() - (*kf1)->getTime() );
+		if( cursor != NULL && cursor->mKeyFrameIndex < last_kfi &&
+			mKeyTimes[ cursor->mKeyFrameIndex ] <= time )
+		{
+			// step forward from the cursor
+			kfi1 = cursor->mKeyFrameIndex;
+			for( unsigned int si = 0; si < max_steps && mKeyTimes[kfi1+1] <= time; ++si )
+				++kfi1;
+
+			if( mKeyTimes[kfi1+1] <= time )
+				// too far ahead, look it up
+				kfi1 = _findKeyFrameIndex(time);
+		}
+		else
+		{
+			kfi1 = _findKeyFrameIndex(time);
+		}
+
+		kfi2 = kfi1 + 1;
 	}
 
-	return t;
+	if( cursor != NULL )
+		cursor->mKeyFrameIndex = kfi1;
+
+	if( kfi1 == kfi2 )
+		return 0;
+
+	return ( time - mKeyTimes[kfi1] ) / ( mKeyTimes[kfi2] - mKeyTimes[kfi1] );
+}
+
+bool AnimationTrack::hasUniformKeyFrameSpacing() const
+{
+	return mKeySpacing > 0;
 }
 
 float AnimationTrack::getLength() const
@@ -188,7 +220,72 @@ float AnimationTrack::getLength() const
 	if( getNumKeyFrames() <= 0 )
 		return 0;
 
-	return mKeyFrames[ getNumKeyFrames() - 1 ]->getTime();
+	return mKeyTimes[ getNumKeyFrames() - 1 ];
+}
+
+unsigned int AnimationTrack::_insertKeyFrame( float time )
+{
+	std::vector<float>::iterator ti =
+		std::lower_bound( mKeyTimes.begin(), mKeyTimes.end(), time );
+	unsigned int kfi = ti - mKeyTimes.begin();
+
+	// is there already a key-frame at this time?
+	if( kfi > 0 && zhEqualf( mKeyTimes[kfi-1], time ) )
+		return kfi - 1;
+	if( kfi < mKeyTimes.size() && zhEqualf( mKeyTimes[kfi], time ) )
+		return kfi;
+
+	mKeyTimes.insert( ti, time );
+	if( !mKeyFrames.empty() )
+		// key-frame views already exist, keep them in sync
+		mKeyFrames.insert( mKeyFrames.begin() + kfi, _createKeyFrame(time) );
+	_insertKeyFrameData(kfi);
+
+	// appending is the common case (loaders), so don't renumber unless we have to
+	if( kfi + 1 < mKeyTimes.size() )
+	{
+		_updateKeyFrameIndices();
+		_updateKeyFrameSpacing();
+	}
+	else
+	{
+		if( !mKeyFrames.empty() )
+			mKeyFrames[kfi]->_setIndex(kfi);
+
+		if( kfi <= 1 )
+			_updateKeyFrameSpacing();
+		else if( mKeySpacing > 0 &&
+			!zhEqualf_t( mKeyTimes[kfi], mKeyTimes[0] + kfi * mKeySpacing, 0.1f * mKeySpacing ) )
+			// appended key-frame breaks uniform spacing
+			mKeySpacing = mInvKeySpacing = 0;
+	}
+
+	return kfi;
+}
+
+void AnimationTrack::_destroyKeyFrames()
+{
+	for( unsigned int kfi = 0; kfi < mKeyFrames.size(); ++kfi )
+		delete mKeyFrames[kfi];
+
+	mKeyFrames.clear();
+	mKeyTimes.clear();
+	mKeySpacing = mInvKeySpacing = 0;
+}
+
+void AnimationTrack::_createKeyFrameViews() const
+{
+	if( !mKeyFrames.empty() || mKeyTimes.empty() )
+		return;
+
+	AnimationTrack* track = const_cast<AnimationTrack*>(this);
+	mKeyFrames.reserve( mKeyTimes.size() );
+	for( unsigned int kfi = 0; kfi < mKeyTimes.size(); ++kfi )
+	{
+		KeyFrame* kf = track->_createKeyFrame( mKeyTimes[kfi] );
+		kf->_setIndex(kfi);
+		mKeyFrames.push_back(kf);
+	}
 }
 
 void AnimationTrack::_updateKeyFrameIndices()
@@ -197,4 +294,55 @@ void AnimationTrack::_updateKeyFrameIndices()
 		mKeyFrames[kfi]->_setIndex(kfi);
 }
 
+void AnimationTrack::_updateKeyFrameSpacing()
+{
+	mKeySpacing = mInvKeySpacing = 0;
+
+	unsigned int num_kf = mKeyTimes.size();
+	if( num_kf < 2 )
+		return;
+
+	float spacing = ( mKeyTimes[num_kf-1] - mKeyTimes[0] ) / ( num_kf - 1 );
+	if( spacing <= 0 )
+		return;
+
+	// each key-frame must be within 10% of spacing from its expected time,
+	// so that the computed index is never off by more than one
+	for( unsigned int kfi = 1; kfi < num_kf - 1; ++kfi )
+	{
+		if( !zhEqualf_t( mKeyTimes[kfi], mKeyTimes[0] + kfi * spacing, 0.1f * spacing ) )
+			return;
+	}
+
+	mKeySpacing = spacing;
+	mInvKeySpacing = 1.f / spacing;
+}
+
+unsigned int AnimationTrack::_findKeyFrameIndex( float time ) const
+{
+	zhAssert( mKeyTimes.size() > 1 && time >= mKeyTimes[0] && time < mKeyTimes[ mKeyTimes.size() - 1 ] );
+
+	if( mKeySpacing > 0 )
+	{
+		// uniform spacing, compute index directly
+		unsigned int last_kfi = mKeyTimes.size() - 1;
+		unsigned int kfi = (unsigned int)( ( time - mKeyTimes[0] ) * mInvKeySpacing );
+		if( kfi >= last_kfi )
+			kfi = last_kfi - 1;
+
+		// correct for rounding and jitter in key-frame times
+		while( kfi > 0 && mKeyTimes[kfi] > time )
+			--kfi;
+		while( mKeyTimes[kfi+1] <= time )
+			++kfi;
+
+		return kfi;
+	}
+
+	std::vector<float>::const_iterator ti =
+		std::upper_bound( mKeyTimes.begin(), mKeyTimes.end(), time );
+
+	return ( ti - mKeyTimes.begin() ) - 1;
+}
+
 }
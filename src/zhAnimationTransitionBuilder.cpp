@@ -25,18 +25,32 @@ SOFTWARE.
 #include "zhSkeleton.h"
 #include "zhAnimationSpace.h"
 #include "zhAnimationDistanceGrid.h"
+#include "zhThreadPool.h"
 
 namespace zh
 {
 
 AnimationTransitionBuilder::AnimationTransitionBuilder( Skeleton* skel )
-: mSkel(skel)
+: mSkel(skel), mThreadPool(NULL)
 {
 	zhAssert( skel != NULL );
+
+	mThreadPool = new ThreadPool();
 }
 
 AnimationTransitionBuilder::~AnimationTransitionBuilder()
 {
+	delete mThreadPool;
+}
+
+unsigned int AnimationTransitionBuilder::getNumThreads() const
+{
+	return mThreadPool->getNumWorkers();
+}
+
+void AnimationTransitionBuilder::setNumThreads( unsigned int numThreads )
+{
+	mThreadPool->setNumWorkers(numThreads);
 }
 
 unsigned int AnimationTransitionBuilder::buildTransitions( AnimationSpace* srcAnim, AnimationSpace* trgAnim,
@@ -207,7 +221,7 @@ unsigned int AnimationTransitionBuilder::buildTransitions( Animation* srcAnim, A
 	AnimationSegment src_anim( srcAnim, 0, srcAnim->getLength() );
 	AnimationSegment trg_anim( trgAnim->getBaseAnimation(0), 0, trgAnim->getBaseAnimation(0)->getLength() );
 	AnimationDistanceGrid* grid = new AnimationDistanceGrid( mSkel, src_anim, trg_anim, zhAnimation_SampleRate );
-	grid->build(transLength);
+	grid->build( transLength, mThreadPool );
 
 	// find transition points
 	num_trans = grid->findLocalMinima(minDist);
@@ -323,7 +337,7 @@ unsigned int AnimationTransitionBuilder::buildTransitions( Animation* srcAnim, A
 	AnimationSegment src_anim( srcAnim, 0, srcAnim->getLength() );
 	AnimationSegment trg_anim( trgAnim, 0, trgAnim->getLength() );
 	AnimationDistanceGrid* grid = new AnimationDistanceGrid( mSkel, src_anim, trg_anim, zhAnimation_SampleRate );
-	grid->build(transLength);
+	grid->build( transLength, mThreadPool );
 
 	// find transition points
 	num_trans = grid->findLocalMinima(minDist);
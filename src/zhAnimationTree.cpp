@@ -28,7 +28,8 @@ namespace zh
 {
 
 AnimationTree::AnimationTree( const std::string& name ) :
-mName(name), mRoot(NULL), mApplyMover(true), mTotalWeight(0)
+mName(name), mRoot(NULL), mApplyMover(true), mAnnotsEnabled(true), mTotalWeight(0), mCurPoseAccum(NULL),
+mProgramEnabled(false)
 {
 }
 
@@ -50,11 +51,13 @@ AnimationNode* AnimationTree::getRoot() const
 void AnimationTree::setRoot( unsigned short id )
 {
 	mRoot = getNode(id);
+	_invalidateProgram();
 }
 
 void AnimationTree::setRoot( const std::string& name )
 {
 	mRoot = getNode(name);
+	_invalidateProgram();
 }
 
 void AnimationTree::setRoot( AnimationNode* node )
@@ -63,6 +66,7 @@ void AnimationTree::setRoot( AnimationNode* node )
 		hasNode( node->getId() ) && node->getParent() == NULL );
 
 	mRoot = node;
+	_invalidateProgram();
 }
 
 AnimationNode* AnimationTree::createNode( unsigned long classId,
@@ -108,6 +112,7 @@ void AnimationTree::deleteNode( unsigned short id )
 		mNodesById.erase(ani);
 		mNodesByName.erase( node->getName() );
 		delete node;
+		_invalidateProgram();
 	}
 }
 
@@ -134,6 +139,7 @@ void AnimationTree::deleteNode( const std::string& name )
 		mNodesById.erase( node->getId() );
 		mNodesByName.erase(name);
 		delete node;
+		_invalidateProgram();
 	}
 }
 
@@ -150,6 +156,7 @@ void AnimationTree::deleteAllNodes()
 	mNodesById.clear();
 	mNodesByName.clear();
 	mRoot = NULL;
+	_invalidateProgram();
 }
 
 bool AnimationTree::hasNode( unsigned short id ) const
@@ -217,10 +224,31 @@ void AnimationTree::update( float dt )
 		mRoot->update(dt);
 }
 
-void AnimationTree::apply( Skeleton* skel) const
+bool AnimationTree::getAnnotationsEnabled() const
+{
+	return mAnnotsEnabled;
+}
+
+void AnimationTree::setAnnotationsEnabled( bool enabled )
+{
+	mAnnotsEnabled = enabled;
+}
+
+bool AnimationTree::getProgramEnabled() const
+{
+	return mProgramEnabled;
+}
+
+void AnimationTree::setProgramEnabled( bool enabled )
+{
+	mProgramEnabled = enabled;
+}
+
+void AnimationTree::apply( Skeleton* skel, const BoneMask& boneMask ) const
 {
 	zhAssert( skel != NULL );
 	mCurSkel = skel;
+	mCurPoseAccum = NULL;
 
 	// reset character to initial pose
 	mPrevSit = mCurSkel->getSituation();
@@ -236,8 +264,22 @@ void AnimationTree::apply( Skeleton* skel) const
 
 	// apply node tree
 	AnimationNode* root = getRoot();
-	if( root != NULL )
-		root->apply(1);
+	if( root == NULL )
+		return;
+
+	if( mProgramEnabled )
+	{
+		if( !mProgram.isValid() )
+			mProgram.compile(this);
+
+		if( mProgram.isSupported() )
+		{
+			mProgram.run( const_cast<AnimationTree*>(this), boneMask );
+			return;
+		}
+	}
+
+	root->apply( 1, boneMask );
 }
 
 void AnimationTree::_clone( AnimationTree* clonePtr ) const
@@ -269,6 +311,8 @@ void AnimationTree::_clone( AnimationTree* clonePtr ) const
 
 	// Copy settings
 	clone->mApplyMover = mApplyMover;
+	clone->mAnnotsEnabled = mAnnotsEnabled;
+	clone->mProgramEnabled = mProgramEnabled;
 }
 
 void AnimationTree::_renameNode( AnimationNode* node, const std::string& newName )
@@ -309,6 +353,16 @@ void AnimationTree::_setCurrentSkeleton( Skeleton* skel )
 	mCurSkel = skel;
 }
 
+PoseAccumulator* AnimationTree::_getCurrentPoseAccumulator() const
+{
+	return mCurPoseAccum;
+}
+
+void AnimationTree::_setCurrentPoseAccumulator( PoseAccumulator* poseAccum )
+{
+	mCurPoseAccum = poseAccum;
+}
+
 const Skeleton::Situation& AnimationTree::_getPrevSituation() const
 {
 	return mPrevSit;
@@ -319,4 +373,14 @@ void AnimationTree::_setPrevSituation( const Skeleton::Situation& sit )
 	mPrevSit = sit;
 }
 
+const AnimationProgram& AnimationTree::_getProgram() const
+{
+	return mProgram;
+}
+
+void AnimationTree::_invalidateProgram()
+{
+	mProgram.invalidate();
+}
+
 }
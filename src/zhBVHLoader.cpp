@@ -156,12 +156,15 @@ namespace zh
 				mAnim->setFrameRate( zhRoundi(1.f/frameTime) );
 			BoneAnimationTrack* root_tr = mAnim->createBoneTrack(jointID);
 			for(int i = 0;i < nFrames;++i){
-				TransformKeyFrame* tkf = static_cast<TransformKeyFrame*>(root_tr->createKeyFrame(i * frameTime));
 				if(this->numberOfChannels == 6){
-					tkf->setTranslation(Vector3(this->keyframes[0][i],this->keyframes[1][i],this->keyframes[2][i]));
-					tkf->setRotation( Quat(zhRad(this->keyframes[3][i]),zhRad(this->keyframes[4][i]),zhRad(this->keyframes[5][i]),this->channelOrder));
+					root_tr->createTransformKeyFrame(i * frameTime,
+						Vector3(this->keyframes[0][i],this->keyframes[1][i],this->keyframes[2][i]),
+						Quat(zhRad(this->keyframes[3][i]),zhRad(this->keyframes[4][i]),zhRad(this->keyframes[5][i]),this->channelOrder));
 				}else if(this->numberOfChannels == 3){
-					tkf->setRotation( Quat(zhRad(this->keyframes[0][i]),zhRad(this->keyframes[1][i]),zhRad(this->keyframes[2][i]),this->channelOrder));
+					root_tr->createTransformKeyFrame(i * frameTime, Vector3(),
+						Quat(zhRad(this->keyframes[0][i]),zhRad(this->keyframes[1][i]),zhRad(this->keyframes[2][i]),this->channelOrder));
+				}else{
+					root_tr->createTransformKeyFrame(i * frameTime, Vector3(), Quat());
 				}
 			}
 			for(int i = 0;i < children.size();++i){
@@ -398,6 +401,7 @@ namespace zh
 
 		mAnim = mAnimSet->createAnimation(0, mAnimSet->getName());
 		root -> ConvertToAnimation(mAnim);
+		mAnim->buildInterpSplines();
 		return true;
 	}
 }
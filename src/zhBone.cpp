@@ -27,7 +27,7 @@ namespace zh
 {
 
 Bone::Bone( unsigned short id, const std::string& name, Skeleton* skel ) :
-mId(id), mName(name), mSkel(skel), mParent(NULL)
+mId(id), mName(name), mSkel(skel), mIndex(0), mParent(NULL), mWorldDirty(true)
 {
 	zhAssert( skel != NULL );
 
@@ -48,6 +48,13 @@ Skeleton* Bone::getSkeleton() const
 	return mSkel;
 }
 
+unsigned int Bone::getIndex() const
+{
+	mSkel->_compileTopology();
+
+	return mIndex;
+}
+
 const Vector3& Bone::getPosition() const
 {
 	return mPos;
@@ -56,23 +63,15 @@ const Vector3& Bone::getPosition() const
 void Bone::setPosition( const Vector3& pos )
 {
 	mPos = pos;
+	_invalidateWorldTransform();
 }
 
 Vector3 Bone::getWorldPosition() const
 {
-	Vector3 wpos;
-	
-	if( mParent == NULL )
-	{
-		wpos = mPos;
-	}
-	else
-	{
-		wpos = mParent->getWorldPosition() +
-			( mParent->getWorldScale() * mPos ).rotate( mParent->getWorldOrientation() );
-	}
+	if( mWorldDirty )
+		_updateWorldTransform();
 
-	return wpos;
+	return mWorldPos;
 }
 
 const Vector3& Bone::getInitialPosition() const
@@ -83,6 +82,7 @@ const Vector3& Bone::getInitialPosition() const
 void Bone::setInitialPosition( const Vector3& pos )
 {
 	mInitPos = pos;
+	mSkel->_invalidateTopology();
 }
 
 const Quat& Bone::getOrientation() const
@@ -93,22 +93,15 @@ const Quat& Bone::getOrientation() const
 void Bone::setOrientation( const Quat& orient )
 {
 	mOrient = orient;
+	_invalidateWorldTransform();
 }
 
 Quat Bone::getWorldOrientation() const
 {
-	Quat worient;
+	if( mWorldDirty )
+		_updateWorldTransform();
 
-	if( mParent == NULL )
-	{
-		worient = mOrient;
-	}
-	else
-	{
-		worient = mParent->getWorldOrientation() * mOrient;
-	}
-
-	return worient;
+	return mWorldOrient;
 }
 
 const Quat& Bone::getInitialOrientation() const
@@ -119,6 +112,7 @@ const Quat& Bone::getInitialOrientation() const
 void Bone::setInitialOrientation( const Quat& orient )
 {
 	mInitOrient = orient;
+	mSkel->_invalidateTopology();
 }
 
 const Vector3& Bone::getScale() const
@@ -129,22 +123,15 @@ const Vector3& Bone::getScale() const
 void Bone::setScale( const Vector3& scal )
 {
 	mScal = scal;
+	_invalidateWorldTransform();
 }
 
 Vector3 Bone::getWorldScale() const
 {
-	Vector3 wscal;
-
-	if( mParent == NULL )
-	{
-		wscal = mScal;
-	}
-	else
-	{
-		wscal = mParent->getWorldScale() * mScal;
-	}
+	if( mWorldDirty )
+		_updateWorldTransform();
 
-	return wscal;
+	return mWorldScal;
 }
 
 const Vector3& Bone::getInitialScale() const
@@ -155,6 +142,7 @@ const Vector3& Bone::getInitialScale() const
 void Bone::setInitialScale( const Vector3& scal )
 {
 	mInitScal = scal;
+	mSkel->_invalidateTopology();
 }
 
 void Bone::resetToInitialPose()
@@ -162,16 +150,19 @@ void Bone::resetToInitialPose()
 	mPos = mInitPos;
 	mOrient = mInitOrient;
 	mScal = mInitScal;
+	_invalidateWorldTransform();
 }
 
 void Bone::translate( const Vector3& trans )
 {
 	mPos += trans;
+	_invalidateWorldTransform();
 }
 
 void Bone::rotate( const Quat& rot )
 {
 	mOrient *= rot.getNormalized();
+	_invalidateWorldTransform();
 }
 
 void Bone::rotate( float yaw, float pitch, float roll )
@@ -182,6 +173,7 @@ void Bone::rotate( float yaw, float pitch, float roll )
 void Bone::scale( const Vector3& scal )
 {
 	mScal *= scal;
+	_invalidateWorldTransform();
 }
 
 Bone* Bone::getParent() const
@@ -199,6 +191,9 @@ void Bone::addChild( Bone* bone )
 	bone->mParent = this;
 	mChildrenById.insert( std::make_pair( bone->getId(), bone ) );
 	mChildrenByName.insert( std::make_pair( bone->getName(), bone ) );
+	bone->mWorldDirty = false; // force invalidation of the subtree
+	bone->_invalidateWorldTransform();
+	mSkel->_invalidateTopology();
 }
 
 void Bone::removeChild( unsigned short childId )
@@ -212,6 +207,9 @@ void Bone::removeChild( unsigned short childId )
 		mChildrenById.erase(ci);
 		mChildrenByName.erase( child->getName() );
 		child->mParent = NULL;
+		child->mWorldDirty = false;
+		child->_invalidateWorldTransform();
+		mSkel->_invalidateTopology();
 	}
 }
 
@@ -226,6 +224,9 @@ void Bone::removeChild( const std::string& childName )
 		mChildrenByName.erase(ci);
 		mChildrenById.erase( child->getId() );
 		child->mParent = NULL;
+		child->mWorldDirty = false;
+		child->_invalidateWorldTransform();
+		mSkel->_invalidateTopology();
 	}
 }
 
@@ -235,10 +236,13 @@ void Bone::removeAllChildren()
 		ci != mChildrenById.end(); ++ci )
 	{
 		ci->second->mParent = NULL;
+		ci->second->mWorldDirty = false;
+		ci->second->_invalidateWorldTransform();
 	}
 	
 	mChildrenById.clear();
 	mChildrenByName.clear();
+	mSkel->_invalidateTopology();
 }
 
 void Bone::moveChild( unsigned short childId, Bone* bone )
@@ -347,4 +351,39 @@ void Bone::untag()
 	mSkel->_removeBoneTagsFromBone(mId);
 }
 
+void Bone::_invalidateWorldTransform()
+{
+	// if this bone is dirty, so are all its descendants
+	if( mWorldDirty )
+		return;
+
+	mWorldDirty = true;
+
+	for( std::map<unsigned short, Bone*>::iterator ci = mChildrenById.begin();
+		ci != mChildrenById.end(); ++ci )
+		ci->second->_invalidateWorldTransform();
+}
+
+void Bone::_updateWorldTransform() const
+{
+	if( mParent == NULL )
+	{
+		mWorldPos = mPos;
+		mWorldOrient = mOrient;
+		mWorldScal = mScal;
+	}
+	else
+	{
+		if( mParent->mWorldDirty )
+			mParent->_updateWorldTransform();
+
+		mWorldPos = mParent->mWorldPos +
+			( mParent->mWorldScal * mPos ).rotate( mParent->mWorldOrient );
+		mWorldOrient = mParent->mWorldOrient * mOrient;
+		mWorldScal = mParent->mWorldScal * mScal;
+	}
+
+	mWorldDirty = false;
+}
+
 }
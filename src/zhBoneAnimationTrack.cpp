@@ -28,47 +28,72 @@ namespace zh
 {
 
 TransformKeyFrame::TransformKeyFrame( float time, unsigned int index )
-: KeyFrame( time, index )
+: KeyFrame( time, index ), mTrack(NULL), mTransf( new Transform() )
 {
-	mScale = Vector3(1,1,1);
+	mTransf->mScale = Vector3(1,1,1);
+}
+
+TransformKeyFrame::TransformKeyFrame( float time, unsigned int index, BoneAnimationTrack* track )
+: KeyFrame( time, index ), mTrack(track), mTransf(NULL)
+{
+	zhAssert( track != NULL );
 }
 
 TransformKeyFrame::~TransformKeyFrame()
 {
+	delete mTransf;
 }
 
 const Vector3& TransformKeyFrame::getTranslation() const
 {
-	return mTranslation;
+	if( mTrack == NULL )
+		return mTransf->mTranslation;
+
+	return mTrack->getKeyFrameTranslation(mIndex);
 }
 
 void TransformKeyFrame::setTranslation( const Vector3& trans )
 {
-	mTranslation = trans;
+	if( mTrack == NULL )
+		mTransf->mTranslation = trans;
+	else
+		mTrack->setKeyFrameTranslation( mIndex, trans );
 }
 
 const Quat& TransformKeyFrame::getRotation() const
 {
-	return mRotation;
+	if( mTrack == NULL )
+		return mTransf->mRotation;
+
+	return mTrack->getKeyFrameRotation(mIndex);
 }
 
 void TransformKeyFrame::setRotation( const Quat& rot )
 {
-	mRotation = rot;
+	if( mTrack == NULL )
+		mTransf->mRotation = rot;
+	else
+		mTrack->setKeyFrameRotation( mIndex, rot );
 }
 
 const Vector3& TransformKeyFrame::getScale() const
 {
-	return mScale;
+	if( mTrack == NULL )
+		return mTransf->mScale;
+
+	return mTrack->getKeyFrameScale(mIndex);
 }
 
 void TransformKeyFrame::setScale( const Vector3& scal )
 {
-	mScale = scal;
+	if( mTrack == NULL )
+		mTransf->mScale = scal;
+	else
+		mTrack->setKeyFrameScale( mIndex, scal );
 }
 
 BoneAnimationTrack::BoneAnimationTrack( unsigned short boneId, Animation* anim )
-: AnimationTrack(anim), mBoneId(boneId)
+: AnimationTrack(anim), mBoneId(boneId), mKFVersion(0)
 {
 }
 
@@ -86,90 +111,207 @@ void BoneAnimationTrack::getInterpolatedKeyFrame( float time, KeyFrame* kf ) con
 	zhAssert( kf != NULL );
 
 	TransformKeyFrame* tkf = static_cast<TransformKeyFrame*>(kf);
-	KeyFrame *kf1, *kf2;
-	TransformKeyFrame *tkf1, *tkf2;
+	Vector3 trans, scal;
+	Quat rot;
+
+	getInterpolatedTransform( time, trans, rot, scal );
+	tkf->setTranslation(trans);
+	tkf->setRotation(rot);
+	tkf->setScale(scal);
+}
+
+void BoneAnimationTrack::getInterpolatedTransform( float time, Vector3& trans, Quat& rot, Vector3& scal,
+												  KeyFrameCursor* cursor ) const
+{
+	if( mKeyTimes.size() <= 0 )
+	{
+		trans = Vector3();
+		rot = Quat();
+		scal = Vector3(1,1,1);
+		return;
+	}
 
 	// get nearest 2 key-frames
-	float t = getKeyFramesAtTime( time, &kf1, &kf2 );
-	tkf1 = static_cast<TransformKeyFrame*>(kf1);
-	tkf2 = static_cast<TransformKeyFrame*>(kf2);
+	unsigned int kfi1, kfi2;
+	float t = getKeyFrameIndicesAtTime( time, kfi1, kfi2, cursor );
 
 	// interpolate between them
 	if( zhEqualf( t, 0 ) )
 	{
-		tkf->setTranslation( tkf1->getTranslation() );
-		tkf->setRotation( tkf1->getRotation() );
-		tkf->setScale( tkf1->getScale() );
+		trans = mTranslations[kfi1];
+		rot = mRotations[kfi1];
+		scal = mScales[kfi1];
 	}
 	else if( zhEqualf( t, 1 ) )
 	{
-		tkf->setTranslation( tkf2->getTranslation() );
-		tkf->setRotation( tkf2->getRotation() );
-		tkf->setScale( tkf2->getScale() );
+		trans = mTranslations[kfi2];
+		rot = mRotations[kfi2];
+		scal = mScales[kfi2];
 	}
 	else
 	{
-		Vector3 v1, v2;
-		Quat q1, q2;
-
 		// interpolate transformations
 		if( mAnim->getKFInterpolationMethod() == KFInterp_Linear )
 		{
-			v1 = tkf1->getTranslation();
-			v2 = tkf2->getTranslation();
-			tkf->setTranslation( v1 + ( v2 - v1 ) * t );
+			const Vector3& v1 = mTranslations[kfi1];
+			trans = v1 + ( mTranslations[kfi2] - v1 ) * t;
 
-			q1 = tkf1->getRotation();
-			q2 = tkf2->getRotation();
-			tkf->setRotation( q1.nlerp( q2, t ) );
+			rot = mRotations[kfi1].nlerp( mRotations[kfi2], t );
 
-			v1 = tkf1->getScale();
-			v2 = tkf2->getScale();
-			tkf->setScale( v1 + ( v2 - v1 ) * t );
+			const Vector3& s1 = mScales[kfi1];
+			scal = s1 + ( mScales[kfi2] - s1 ) * t;
+		}
+		else if( _hasInterpSplines() ) // if( mAnim->getKFInterpolationMethod() == KFInterp_Spline )
+		{
+			mTransSpline.getPoint( kfi1, t, trans );
+			rot = mRotSpline.getPoint( kfi1, t );
+			mScalSpline.getPoint( kfi1, t, scal );
 		}
-		else // if( mAnim->getKFInterpolationMethod() == KFInterp_Spline )
+		else
 		{
-			if( mTransSpline.getNumControlPoints() <= 0 )
-				// interpolation splines not built yet, build them now
-				_buildInterpSplines();
+			// key-frames edited since the splines were built,
+			// fall back to linear interpolation until Animation::buildInterpSplines() is called
+
+			const Vector3& v1 = mTranslations[kfi1];
+			trans = v1 + ( mTranslations[kfi2] - v1 ) * t;
+
+			rot = mRotations[kfi1].nlerp( mRotations[kfi2], t );
 
-			tkf->setTranslation( mTransSpline.getPoint( tkf1->getIndex(), t ) );
-			tkf->setRotation( mRotSpline.getPoint( tkf1->getIndex(), t ) );
-			tkf->setScale( mScalSpline.getPoint( tkf1->getIndex(), t ) );
+			const Vector3& s1 = mScales[kfi1];
+			scal = s1 + ( mScales[kfi2] - s1 ) * t;
 		}
 	}
 }
 
-void BoneAnimationTrack::apply( Skeleton* skel, float time, float weight, float scale ) const
+unsigned int BoneAnimationTrack::createTransformKeyFrame( float time, const Vector3& trans,
+	const Quat& rot, const Vector3& scal )
+{
+	unsigned int kfi = _insertKeyFrame(time);
+	mTranslations[kfi] = trans;
+	mRotations[kfi] = rot;
+	mScales[kfi] = scal;
+	_clearInterpSplines();
+
+	return kfi;
+}
+
+const Vector3& BoneAnimationTrack::getKeyFrameTranslation( unsigned int index ) const
+{
+	zhAssert( index < mTranslations.size() );
+
+	return mTranslations[index];
+}
+
+void BoneAnimationTrack::setKeyFrameTranslation( unsigned int index, const Vector3& trans )
+{
+	zhAssert( index < mTranslations.size() );
+
+	mTranslations[index] = trans;
+	_clearInterpSplines();
+}
+
+const Quat& BoneAnimationTrack::getKeyFrameRotation( unsigned int index ) const
+{
+	zhAssert( index < mRotations.size() );
+
+	return mRotations[index];
+}
+
+void BoneAnimationTrack::setKeyFrameRotation( unsigned int index, const Quat& rot )
+{
+	zhAssert( index < mRotations.size() );
+
+	mRotations[index] = rot;
+	_clearInterpSplines();
+}
+
+const Vector3& BoneAnimationTrack::getKeyFrameScale( unsigned int index ) const
+{
+	zhAssert( index < mScales.size() );
+
+	return mScales[index];
+}
+
+void BoneAnimationTrack::setKeyFrameScale( unsigned int index, const Vector3& scal )
+{
+	zhAssert( index < mScales.size() );
+
+	mScales[index] = scal;
+	_clearInterpSplines();
+}
+
+void BoneAnimationTrack::apply( Skeleton* skel, float time, float weight, float scale,
+							   KeyFrameCursor* cursor ) const
 {
-	TransformKeyFrame tkf( time, 0 );
 	Bone* bone = skel->getBone(mBoneId);
 	if( bone == NULL )
 		// Skeleton doesn't contain a bone for this track
 		return;
 
-	getInterpolatedKeyFrame( time, &tkf );
+	Vector3 trans, scal;
+	Quat rot;
+	getInterpolatedTransform( time, trans, rot, scal, cursor );
 
-	bone->translate( tkf.getTranslation() * weight * scale );
-	bone->rotate( Quat().slerp( tkf.getRotation(), weight ) );
-	bone->scale( Vector3(1,1,1) + ( Vector3(1,1,1) - tkf.getScale() ) * weight * scale );
+	bone->translate( trans * weight * scale );
+	bone->rotate( Quat().slerp( rot, weight ) );
+	bone->scale( Vector3(1,1,1) + ( Vector3(1,1,1) - scal ) * weight * scale );
 }
 
 KeyFrame* BoneAnimationTrack::_createKeyFrame( float time )
 {
-	return new TransformKeyFrame( time, 0 );
+	return new TransformKeyFrame( time, 0, this );
+}
+
+void BoneAnimationTrack::_insertKeyFrameData( unsigned int index )
+{
+	mTranslations.insert( mTranslations.begin() + index, Vector3() );
+	mRotations.insert( mRotations.begin() + index, Quat() );
+	mScales.insert( mScales.begin() + index, Vector3(1,1,1) );
+	_clearInterpSplines();
+}
+
+void BoneAnimationTrack::_deleteKeyFrameData( unsigned int index )
+{
+	mTranslations.erase( mTranslations.begin() + index );
+	mRotations.erase( mRotations.begin() + index );
+	mScales.erase( mScales.begin() + index );
+	_clearInterpSplines();
+}
+
+void BoneAnimationTrack::_deleteAllKeyFrameData()
+{
+	mTranslations.clear();
+	mRotations.clear();
+	mScales.clear();
+	_clearInterpSplines();
+}
+
+void BoneAnimationTrack::_clearInterpSplines()
+{
+	++mKFVersion;
+
+	if( mTransSpline.getNumControlPoints() <= 0 )
+		return;
+
+	mTransSpline.clearControlPoints();
+	mRotSpline.clearControlPoints();
+	mScalSpline.clearControlPoints();
 }
 
-void BoneAnimationTrack::_buildInterpSplines() const
+void BoneAnimationTrack::_buildInterpSplines()
 {
-	TransformKeyFrame* tkf;
+	_clearInterpSplines();
+	if( mKeyTimes.size() < 2 )
+		return;
+
+	mTransSpline.setBakeCoefficients();
+	mScalSpline.setBakeCoefficients();
 
-	for( unsigned int kfi = 0; kfi < mKeyFrames.size(); ++kfi )
+	for( unsigned int kfi = 0; kfi < mKeyTimes.size(); ++kfi )
 	{
-		tkf = static_cast<TransformKeyFrame*>( mKeyFrames[kfi] );
-		mTransSpline.addControlPoint( tkf->getTranslation() );
-		mRotSpline.addControlPoint( tkf->getRotation() );
-		mScalSpline.addControlPoint( tkf->getScale() );
+		mTransSpline.addControlPoint( mTranslations[kfi] );
+		mRotSpline.addControlPoint( mRotations[kfi] );
+		mScalSpline.addControlPoint( mScales[kfi] );
 	}
 
 	mTransSpline.calcTangents();
@@ -177,4 +319,15 @@ void BoneAnimationTrack::_buildInterpSplines() const
 	mScalSpline.calcTangents();
 }
 
+bool BoneAnimationTrack::_hasInterpSplines() const
+{
+	return mTransSpline.getNumControlPoints() > 0 &&
+		mTransSpline.getNumControlPoints() == mKeyTimes.size();
+}
+
+unsigned int BoneAnimationTrack::_getKeyFrameVersion() const
+{
+	return mKFVersion;
+}
+
 }
@@ -0,0 +1,110 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhBoneMask.h"
+
+namespace zh
+{
+
+BoneMask::BoneMask()
+{
+}
+
+BoneMask::BoneMask( unsigned int capacity )
+{
+	reserve(capacity);
+}
+
+BoneMask::BoneMask( const std::set<unsigned short>& boneIds )
+{
+	if( !boneIds.empty() )
+		reserve( *boneIds.rbegin() + 1 );
+
+	for( std::set<unsigned short>::const_iterator bi = boneIds.begin();
+		bi != boneIds.end(); ++bi )
+		insert(*bi);
+}
+
+unsigned int BoneMask::getCapacity() const
+{
+	return mBits.size() * 32;
+}
+
+void BoneMask::reserve( unsigned int capacity )
+{
+	unsigned int num_words = ( capacity + 31 ) / 32;
+	if( num_words > mBits.size() )
+		mBits.resize( num_words, 0 );
+}
+
+void BoneMask::insert( unsigned short boneId )
+{
+	reserve( boneId + 1 );
+	mBits[ boneId >> 5 ] |= 1u << ( boneId & 31 );
+}
+
+void BoneMask::erase( unsigned short boneId )
+{
+	unsigned int wi = boneId >> 5;
+	if( wi < mBits.size() )
+		mBits[wi] &= ~( 1u << ( boneId & 31 ) );
+}
+
+void BoneMask::clear()
+{
+	std::fill( mBits.begin(), mBits.end(), 0 );
+}
+
+bool BoneMask::empty() const
+{
+	for( unsigned int wi = 0; wi < mBits.size(); ++wi )
+		if( mBits[wi] != 0 )
+			return false;
+
+	return true;
+}
+
+void BoneMask::assign( const BoneMask& mask )
+{
+	if( mask.mBits.size() > mBits.size() )
+		mBits.resize( mask.mBits.size(), 0 );
+
+	std::copy( mask.mBits.begin(), mask.mBits.end(), mBits.begin() );
+	std::fill( mBits.begin() + mask.mBits.size(), mBits.end(), 0 );
+}
+
+void BoneMask::getBoneIds( std::set<unsigned short>& boneIds ) const
+{
+	boneIds.clear();
+
+	for( unsigned int wi = 0; wi < mBits.size(); ++wi )
+	{
+		if( mBits[wi] == 0 )
+			continue;
+
+		for( unsigned int bit = 0; bit < 32; ++bit )
+			if( ( mBits[wi] & ( 1u << bit ) ) != 0 )
+				boneIds.insert( (unsigned short)( wi * 32 + bit ) );
+	}
+}
+
+}
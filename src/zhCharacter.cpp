@@ -0,0 +1,186 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhCharacter.h"
+
+namespace zh
+{
+
+Character::Character( const std::string& name, Skeleton* skel, AnimationTree* animTree )
+: mName(name), mSkel(skel), mAnimTree(animTree), mImportance(1), mLODPolicy(NULL),
+mHasEvalPose(false), mEvalTime(0), mEvalInterval(0)
+{
+	zhAssert( skel != NULL && animTree != NULL );
+}
+
+Character::~Character()
+{
+	delete mAnimTree;
+	delete mSkel;
+}
+
+const std::string& Character::getName() const
+{
+	return mName;
+}
+
+Skeleton* Character::getSkeleton() const
+{
+	return mSkel;
+}
+
+AnimationTree* Character::getAnimationTree() const
+{
+	return mAnimTree;
+}
+
+float Character::getImportance() const
+{
+	return mImportance;
+}
+
+void Character::setImportance( float importance )
+{
+	mImportance = importance;
+}
+
+const LODPolicy* Character::getLODPolicy() const
+{
+	return mLODPolicy;
+}
+
+void Character::setLODPolicy( const LODPolicy* lodPolicy )
+{
+	mLODPolicy = lodPolicy;
+}
+
+void Character::update( float dt )
+{
+	bool use_arena = ScratchArena::GetCurrent() == NULL;
+	if(use_arena)
+		ScratchArena::SetCurrent(&mScratchArena);
+
+	const LODLevel* lod = mLODPolicy != NULL ? mLODPolicy->selectLevel(mImportance) : NULL;
+	const BoneMask& bone_mask = lod != NULL ? lod->boneMask : Animation::EmptyBoneMask;
+	mAnimTree->setAnnotationsEnabled( lod == NULL || lod->emitAnnotations );
+
+	if( lod == NULL || lod->updateInterval <= 0 )
+	{
+		// evaluate animation every update
+		float tree_dt = dt;
+		if( mHasEvalPose )
+		{
+			// tree was evaluated ahead, let current time catch up
+			float ahead = mEvalInterval - mEvalTime;
+			tree_dt = dt > ahead ? dt - ahead : 0;
+			mHasEvalPose = false;
+		}
+
+		mAnimTree->update(tree_dt);
+		mAnimTree->apply( mSkel, bone_mask );
+	}
+	else
+	{
+		if( !mHasEvalPose )
+		{
+			// start interpolation from the current pose
+			_storeEvalPose();
+			mHasEvalPose = true;
+			mEvalTime = 0;
+			mEvalInterval = 0;
+		}
+
+		mEvalTime += dt;
+		if( mEvalTime >= mEvalInterval )
+		{
+			// restore the pose the tree was last evaluated at,
+			// so mover and situation are computed relative to it
+			_interpolateEvalPose(1);
+			mPrevPositions.swap(mNextPositions);
+			mPrevOrients.swap(mNextOrients);
+			mPrevScales.swap(mNextScales);
+
+			// evaluate tree one interval ahead
+			mEvalTime -= mEvalInterval;
+			mEvalInterval = mEvalTime > lod->updateInterval ? mEvalTime : lod->updateInterval;
+			mAnimTree->update(mEvalInterval);
+			mAnimTree->apply( mSkel, bone_mask );
+			_storeEvalPose();
+		}
+
+		_interpolateEvalPose( mEvalTime / mEvalInterval );
+	}
+
+	if( lod == NULL || lod->solveIK )
+		mSkel->solveIK();
+	mSkel->updateWorldTransforms();
+
+	if(use_arena)
+	{
+		ScratchArena::SetCurrent(NULL);
+#if zhAllocTracking_Enabled
+		if( mScratchArena.getNumHeapAllocs() > 0 )
+			zhLog( "Character", "update",
+				"%u heap allocations made during update of character %s.",
+				mScratchArena.getNumHeapAllocs(), mName.c_str() );
+#endif
+		mScratchArena.reset();
+	}
+}
+
+EventQueue& Character::_getEventQueue()
+{
+	return mEventQueue;
+}
+
+void Character::_storeEvalPose()
+{
+	unsigned int num_bones = mSkel->getNumBones();
+	mNextPositions.resize(num_bones);
+	mNextOrients.resize(num_bones);
+	mNextScales.resize(num_bones);
+
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+	{
+		Bone* bone = mSkel->getBoneByIndex(bi);
+		mNextPositions[bi] = bone->getPosition();
+		mNextOrients[bi] = bone->getOrientation();
+		mNextScales[bi] = bone->getScale();
+	}
+}
+
+void Character::_interpolateEvalPose( float t )
+{
+	unsigned int num_bones = mSkel->getNumBones();
+	if( mPrevPositions.size() != num_bones || mNextPositions.size() != num_bones )
+		return;
+
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+	{
+		Bone* bone = mSkel->getBoneByIndex(bi);
+		bone->setPosition( mPrevPositions[bi] + ( mNextPositions[bi] - mPrevPositions[bi] ) * t );
+		bone->setOrientation( mPrevOrients[bi].slerp( mNextOrients[bi], t ) );
+		bone->setScale( mPrevScales[bi] + ( mNextScales[bi] - mPrevScales[bi] ) * t );
+	}
+}
+
+}
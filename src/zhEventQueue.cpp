@@ -0,0 +1,99 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhEventQueue.h"
+
+namespace zh
+{
+
+static zhThreadLocal EventQueue* DeferredQueue = NULL;
+
+EventQueue::EventQueue( unsigned int capacity )
+: mNumQueued(0)
+{
+	mSlots.resize(capacity);
+}
+
+EventQueue::~EventQueue()
+{
+	clear();
+}
+
+unsigned int EventQueue::getCapacity() const
+{
+	return mSlots.size();
+}
+
+void EventQueue::setCapacity( unsigned int capacity )
+{
+	zhAssert( getNumEvents() <= 0 );
+
+	mSlots.resize(capacity);
+}
+
+unsigned int EventQueue::getNumEvents() const
+{
+	return mNumQueued;
+}
+
+void EventQueue::flush()
+{
+	zhAssert( DeferredQueue != this );
+
+	_release(true);
+}
+
+void EventQueue::clear()
+{
+	_release(false);
+}
+
+EventQueue* EventQueue::GetDeferredQueue()
+{
+	return DeferredQueue;
+}
+
+void EventQueue::SetDeferredQueue( EventQueue* queue )
+{
+	DeferredQueue = queue;
+}
+
+void EventQueue::_release( bool deliver )
+{
+	unsigned int num_queued = mNumQueued;
+	unsigned int num_slots = num_queued < mSlots.size() ? num_queued : mSlots.size();
+
+	for( unsigned int si = 0; si < num_slots; ++si )
+		mSlots[si].mHandler( mSlots[si], deliver );
+
+	for( unsigned int si = 0; si < mOverflow.size(); ++si )
+		mOverflow[si].mHandler( mOverflow[si], deliver );
+
+	// make room for the overflowing events next time
+	if( !mOverflow.empty() )
+		mSlots.resize( mSlots.size() + mOverflow.size() );
+
+	mOverflow.clear();
+	mNumQueued = 0;
+}
+
+}
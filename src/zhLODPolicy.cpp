@@ -0,0 +1,108 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhLODPolicy.h"
+#include "zhSkeleton.h"
+
+namespace zh
+{
+
+LODLevel::LODLevel( float minImportance, float updateInterval,
+				   bool solveIK, bool emitAnnotations )
+: minImportance(minImportance), updateInterval(updateInterval),
+solveIK(solveIK), emitAnnotations(emitAnnotations)
+{
+}
+
+LODPolicy::LODPolicy()
+{
+}
+
+LODPolicy::~LODPolicy()
+{
+}
+
+unsigned int LODPolicy::addLevel( const LODLevel& level )
+{
+	unsigned int index = 0;
+	while( index < mLevels.size() && mLevels[index].minImportance >= level.minImportance )
+		++index;
+
+	mLevels.insert( mLevels.begin() + index, level );
+
+	return index;
+}
+
+void LODPolicy::removeLevel( unsigned int index )
+{
+	zhAssert( index < mLevels.size() );
+
+	mLevels.erase( mLevels.begin() + index );
+}
+
+void LODPolicy::removeAllLevels()
+{
+	mLevels.clear();
+}
+
+const LODLevel& LODPolicy::getLevel( unsigned int index ) const
+{
+	zhAssert( index < mLevels.size() );
+
+	return mLevels[index];
+}
+
+unsigned int LODPolicy::getNumLevels() const
+{
+	return mLevels.size();
+}
+
+const LODLevel* LODPolicy::selectLevel( float importance ) const
+{
+	if( mLevels.empty() )
+		return NULL;
+
+	for( unsigned int li = 0; li < mLevels.size(); ++li )
+		if( importance >= mLevels[li].minImportance )
+			return &mLevels[li];
+
+	// importance below all levels, use the lowest
+	return &mLevels.back();
+}
+
+void LODPolicy::CreateBoneMask( const Skeleton* skel, const std::set<unsigned short>& boneIds,
+							   BoneMask& boneMask )
+{
+	zhAssert( skel != NULL );
+
+	boneMask.clear();
+
+	Skeleton::BoneConstIterator bone_i = skel->getBoneConstIterator();
+	while( bone_i.hasMore() )
+	{
+		Bone* bone = bone_i.next();
+		if( boneIds.count( bone->getId() ) <= 0 )
+			boneMask.insert( bone->getId() );
+	}
+}
+
+}
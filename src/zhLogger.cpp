@@ -45,6 +45,8 @@ void Logger::write( const char* className, const char* funcName, const char* msg
 	if( mLogfile == NULL )
 		return;
 
+	zhLock_Mutex;
+
 	fputs( mTmr.getTimeStr().c_str(), mLogfile );
 	fputs( "\t", mLogfile );
 	fputs( className, mLogfile );
@@ -59,6 +61,8 @@ void Logger::write( const char* className, const char* funcName, const char* msg
 
 	fputs( "\n", mLogfile );
 	fflush(mLogfile);
+
+	zhUnlock_Mutex;
 }
 
 }
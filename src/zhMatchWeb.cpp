@@ -290,15 +290,212 @@ void MatchWeb::build( unsigned int resampleFactor, float wndLength, float minDis
 	//
 
 	//
-	// 1. Build anim. distance grid and find local minima:
+	// 1. Build anim. distance grid at low resolution and find local minima:
 	//
 
-	//unsigned int sample_rate = mSampleRate/resampleFactor;
-	unsigned int sample_rate = mSampleRate;
+	unsigned int sample_rate = mSampleRate / resampleFactor;
+	sample_rate = sample_rate > 0 ? sample_rate : 1;
 	AnimationDistanceGrid* grid = new AnimationDistanceGrid( mSkel, seg1, seg2, sample_rate );
 	grid->build(wndLength);
 	grid->findLocalMinima( minDist, false, true, maxDistDiff );
 
+	//
+	// 2. - 3. Build chains and bridges at low resolution:
+	//
+
+	_buildPaths( grid, minDist, minChainLength, maxBridgeLength );
+
+	if( mPaths.empty() )
+	{
+		// no matches at low resolution, nothing to refine
+		zhLog( "MatchWeb", "build", "Finished building match web for animation segments %u and %u, no paths found.",
+			mInd.getSegIndex1(), mInd.getSegIndex2() );
+
+		// low-res. grid doesn't match the match web's sample rate, so don't keep it
+		if( sample_rate == mSampleRate )
+		{
+			mDistGrid = grid;
+		}
+		else
+		{
+			delete grid;
+			mDistGrid = NULL;
+		}
+		return;
+	}
+
+	//
+	// 4. Upsample the match web to high resolution:
+	//
+
+	if( sample_rate != mSampleRate )
+	{
+		zhLog( "MatchWeb", "build", "Upsampling match web to %u fps...", mSampleRate );
+
+		// pad each path with 1 extra cell in each direction
+		// and upsample the padded path to form a search region
+		AnimationDistanceGrid* hr_grid = new AnimationDistanceGrid( mSkel, seg1, seg2, mSampleRate );
+		unsigned int num_samples1 = hr_grid->getNumSamples1(),
+			num_samples2 = hr_grid->getNumSamples2();
+		std::vector<bool> region( num_samples1 * num_samples2, false );
+		for( unsigned int pathi = 0; pathi < mPaths.size(); ++pathi )
+		{
+			for( unsigned int pti = 0; pti < mPaths[pathi].getNumPoints(); ++pti )
+			{
+				const AnimationDistanceGrid::Index& ptind = mPaths[pathi].getPoint(pti).getIndex();
+
+				unsigned int lb = ptind.first > 0 ? ( ptind.first - 1 ) * mSampleRate / sample_rate : 0,
+					bb = ptind.second > 0 ? ( ptind.second - 1 ) * mSampleRate / sample_rate : 0,
+					rb = ( ( ptind.first + 1 ) * mSampleRate + sample_rate - 1 ) / sample_rate,
+					tb = ( ( ptind.second + 1 ) * mSampleRate + sample_rate - 1 ) / sample_rate;
+				rb = rb < num_samples1 ? rb : num_samples1 - 1;
+				tb = tb < num_samples2 ? tb : num_samples2 - 1;
+
+				for( unsigned int si2 = bb; si2 <= tb; ++si2 )
+					for( unsigned int si1 = lb; si1 <= rb; ++si1 )
+						region[ si1 + num_samples1 * si2 ] = true;
+			}
+		}
+
+		// minDist is relative to the grid's distance range, which is narrower
+		// in the search region, so keep the absolute threshold of the low-res. grid
+		float abs_min_dist = grid->getMinDistance() + minDist * ( grid->getMaxDistance() - grid->getMinDistance() );
+
+		// rebuild the paths at high resolution, inside the search region
+		mPaths.clear();
+		delete grid;
+		grid = hr_grid;
+		grid->build( region, wndLength );
+		float hr_min_dist = grid->getMaxDistance() > grid->getMinDistance() ?
+			( abs_min_dist - grid->getMinDistance() ) / ( grid->getMaxDistance() - grid->getMinDistance() ) : minDist;
+		grid->findLocalMinima( hr_min_dist, false, true, maxDistDiff );
+		_buildPaths( grid, hr_min_dist, minChainLength, maxBridgeLength );
+	}
+
+	zhLog( "MatchWeb", "build", "Finished building match web for animation segments %u and %u.",
+		mInd.getSegIndex1(), mInd.getSegIndex2() );
+
+	//#ifdef _DEBUG
+	mDistGrid = grid;
+	//#else
+	//delete grid;
+	//#endif
+}
+
+void MatchWeb::addPath( const Path& path )
+{
+	mPaths.push_back(path);
+}
+
+void MatchWeb::removePath( unsigned int pathIndex )
+{
+	zhAssert( pathIndex < getNumPaths() );
+
+	mPaths.erase( mPaths.begin() + pathIndex );
+}
+
+const MatchWeb::Path& MatchWeb::getPath( unsigned int pathIndex ) const
+{
+	zhAssert( pathIndex < getNumPaths() );
+
+	return mPaths[pathIndex];
+}
+
+void MatchWeb::setPath( unsigned int pathIndex, const Path& path )
+{
+	zhAssert( pathIndex < getNumPaths() );
+
+	mPaths[pathIndex] = path;
+}
+
+unsigned int MatchWeb::getNumPaths() const
+{
+	return mPaths.size();
+}
+
+unsigned int MatchWeb::search( const AnimationSegment& animSeg, std::vector<Match>& matches,
+							  float maxOverlap ) const
+{
+	const AnimationSegment& seg1 = getAnimation1();
+	const AnimationSegment& seg2 = getAnimation2();
+
+	zhAssert( animSeg.getAnimation() == seg1.getAnimation() ||
+		animSeg.getAnimation() == seg2.getAnimation() );
+
+	if( mPaths.size() <= 0 )
+		return 0;
+
+	zhLog( "MatchWeb", "search", "Searching match web of animation segments %u and %u for matches to animation segment %u, %s [ %f, %f ].",
+		mInd.getSegIndex1(), mInd.getSegIndex2(),
+		animSeg.getAnimation()->getId(), animSeg.getAnimation()->getName().c_str(),
+		animSeg.getStartTime(), animSeg.getEndTime() );
+
+	unsigned int start_fr, end_fr;
+	start_fr = animSeg.getAnimation() == seg1.getAnimation() ? getFrameAtTime1( animSeg.getStartTime() ) : getFrameAtTime2( animSeg.getStartTime() );
+	end_fr = animSeg.getAnimation() == seg1.getAnimation() ? getFrameAtTime1( animSeg.getEndTime() ) : getFrameAtTime2( animSeg.getEndTime() );
+	std::vector<Path> match_segs; // intersecting match web path segments
+	
+	// compute intersecting path segments
+	for( unsigned int pti = 0; pti < getNumPaths(); ++pti )
+	{
+		_intersectPath( animSeg, getPath(pti), Path(), match_segs );
+	}
+
+	std::set<Match> all_matches;
+
+	// compute matches
+	for( unsigned int seg_i = 0; seg_i < match_segs.size(); ++seg_i )
+	{
+		unsigned int seg_endfr = animSeg.getAnimation() == seg1.getAnimation() ?
+			match_segs[seg_i].getLastPoint().getIndex().first : match_segs[seg_i].getLastPoint().getIndex().second;
+
+		float start_time = animSeg.getAnimation() == seg1.getAnimation() ? getTimeAtFrame2( match_segs[seg_i].getPoint(0).getIndex().second ) :
+			getTimeAtFrame1( match_segs[seg_i].getPoint(0).getIndex().first ),
+			end_time = animSeg.getAnimation() == seg1.getAnimation() ? getTimeAtFrame2( match_segs[seg_i].getLastPoint().getIndex().second ) :
+			getTimeAtFrame1( match_segs[seg_i].getLastPoint().getIndex().first );
+		all_matches.insert(
+			Match(
+			AnimationSegment( animSeg.getAnimation() == seg1.getAnimation() ? seg2.getAnimation() : seg1.getAnimation(),
+			start_time, end_time ),
+			match_segs[seg_i] )
+			);
+	}
+
+	// discard overlapping matches
+	while( !all_matches.empty() )
+	{
+		matches.push_back( *all_matches.begin() );
+		all_matches.erase( all_matches.begin() );
+
+		for( std::set<Match>::iterator match_i = all_matches.begin();
+			match_i != all_matches.end(); )
+		{
+			if( match_i->getAnimationSegment().overlap(
+				matches[ matches.size() - 1 ].getAnimationSegment() ) > maxOverlap )
+			{
+				std::set<Match>::iterator rmatch_i = match_i;
+				++match_i;
+				all_matches.erase( rmatch_i );
+			}
+			else
+			{
+				++match_i;
+			}
+		}
+	}
+
+	zhLog( "MatchWeb", "search", "Finished searching match web of animation segments %u and %u for matches to animation segment %u, %s [ %f, %f ]. Found %u matches.",
+		mInd.getSegIndex1(), mInd.getSegIndex2(),
+		animSeg.getAnimation()->getId(), animSeg.getAnimation()->getName().c_str(),
+		animSeg.getStartTime(), animSeg.getEndTime(), matches.size() );
+	
+	return matches.size();
+}
+
+void MatchWeb::_buildPaths( AnimationDistanceGrid* grid, float minDist, float minChainLength, float maxBridgeLength )
+{
+	unsigned int sample_rate = grid->getSampleRate();
+
 	//
 	// 2. For each local minimum without left, bottom or bottom-left neighbors, build a chain C:
 	//
@@ -563,131 +760,6 @@ void MatchWeb::build( unsigned int resampleFactor, float wndLength, float minDis
 
 	bridges.clear();
 	branches.clear();
-
-	//
-	// 4. Upsample the match web to high resolution:
-	//
-
-	// TODO
-
-	zhLog( "MatchWeb", "build", "Finished building match web for animation segments %u and %u.",
-		mInd.getSegIndex1(), mInd.getSegIndex2() );
-
-	//#ifdef _DEBUG
-	mDistGrid = grid;
-	//#else
-	//delete grid;
-	//#endif
-}
-
-void MatchWeb::addPath( const Path& path )
-{
-	mPaths.push_back(path);
-}
-
-void MatchWeb::removePath( unsigned int pathIndex )
-{
-	zhAssert( pathIndex < getNumPaths() );
-
-	mPaths.erase( mPaths.begin() + pathIndex );
-}
-
-const MatchWeb::Path& MatchWeb::getPath( unsigned int pathIndex ) const
-{
-	zhAssert( pathIndex < getNumPaths() );
-
-	return mPaths[pathIndex];
-}
-
-void MatchWeb::setPath( unsigned int pathIndex, const Path& path )
-{
-	zhAssert( pathIndex < getNumPaths() );
-
-	mPaths[pathIndex] = path;
-}
-
-unsigned int MatchWeb::getNumPaths() const
-{
-	return mPaths.size();
-}
-
-unsigned int MatchWeb::search( const AnimationSegment& animSeg, std::vector<Match>& matches,
-							  float maxOverlap ) const
-{
-	const AnimationSegment& seg1 = getAnimation1();
-	const AnimationSegment& seg2 = getAnimation2();
-
-	zhAssert( animSeg.getAnimation() == seg1.getAnimation() ||
-		animSeg.getAnimation() == seg2.getAnimation() );
-
-	if( mPaths.size() <= 0 )
-		return 0;
-
-	zhLog( "MatchWeb", "search", "Searching match web of animation segments %u and %u for matches to animation segment %u, %s [ %f, %f ].",
-		mInd.getSegIndex1(), mInd.getSegIndex2(),
-		animSeg.getAnimation()->getId(), animSeg.getAnimation()->getName().c_str(),
-		animSeg.getStartTime(), animSeg.getEndTime() );
-
-	unsigned int start_fr, end_fr;
-	start_fr = animSeg.getAnimation() == seg1.getAnimation() ? getFrameAtTime1( animSeg.getStartTime() ) : getFrameAtTime2( animSeg.getStartTime() );
-	end_fr = animSeg.getAnimation() == seg1.getAnimation() ? getFrameAtTime1( animSeg.getEndTime() ) : getFrameAtTime2( animSeg.getEndTime() );
-	std::vector<Path> match_segs; // intersecting match web path segments
-	
-	// compute intersecting path segments
-	for( unsigned int pti = 0; pti < getNumPaths(); ++pti )
-	{
-		_intersectPath( animSeg, getPath(pti), Path(), match_segs );
-	}
-
-	std::set<Match> all_matches;
-
-	// compute matches
-	for( unsigned int seg_i = 0; seg_i < match_segs.size(); ++seg_i )
-	{
-		unsigned int seg_endfr = animSeg.getAnimation() == seg1.getAnimation() ?
-			match_segs[seg_i].getLastPoint().getIndex().first : match_segs[seg_i].getLastPoint().getIndex().second;
-
-		float start_time = animSeg.getAnimation() == seg1.getAnimation() ? getTimeAtFrame2( match_segs[seg_i].getPoint(0).getIndex().second ) :
-			getTimeAtFrame1( match_segs[seg_i].getPoint(0).getIndex().first ),
-			end_time = animSeg.getAnimation() == seg1.getAnimation() ? getTimeAtFrame2( match_segs[seg_i].getLastPoint().getIndex().second ) :
-			getTimeAtFrame1( match_segs[seg_i].getLastPoint().getIndex().first );
-		all_matches.insert(
-			Match(
-			AnimationSegment( animSeg.getAnimation() == seg1.getAnimation() ? seg2.getAnimation() : seg1.getAnimation(),
-			start_time, end_time ),
-			match_segs[seg_i] )
-			);
-	}
-
-	// discard overlapping matches
-	while( !all_matches.empty() )
-	{
-		matches.push_back( *all_matches.begin() );
-		all_matches.erase( all_matches.begin() );
-
-		for( std::set<Match>::iterator match_i = all_matches.begin();
-			match_i != all_matches.end(); )
-		{
-			if( match_i->getAnimationSegment().overlap(
-				matches[ matches.size() - 1 ].getAnimationSegment() ) > maxOverlap )
-			{
-				std::set<Match>::iterator rmatch_i = match_i;
-				++match_i;
-				all_matches.erase( rmatch_i );
-			}
-			else
-			{
-				++match_i;
-			}
-		}
-	}
-
-	zhLog( "MatchWeb", "search", "Finished searching match web of animation segments %u and %u for matches to animation segment %u, %s [ %f, %f ]. Found %u matches.",
-		mInd.getSegIndex1(), mInd.getSegIndex2(),
-		animSeg.getAnimation()->getId(), animSeg.getAnimation()->getName().c_str(),
-		animSeg.getStartTime(), animSeg.getEndTime(), matches.size() );
-	
-	return matches.size();
 }
 
 void MatchWeb::_computePathAABB( unsigned int pathIndex, unsigned int& lBound, unsigned int& bBound, 
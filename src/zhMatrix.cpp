@@ -26,37 +26,28 @@ SOFTWARE.
 namespace zh
 {
 
-Matrix::Matrix()
+Matrix::Matrix() : mN(0), mCapacity( zhMatrix_InlineSize * zhMatrix_InlineSize ), mMat(mBuffer)
 {
-	mN = 0;
-	mMat = NULL;
-
-	identity();
 }
 
-Matrix::Matrix( unsigned int n )
+Matrix::Matrix( unsigned int n ) : mN(0), mCapacity( zhMatrix_InlineSize * zhMatrix_InlineSize ), mMat(mBuffer)
 {
 	zhAssert( n > 0 );
 
-	mN = n;
-	mMat = new float[mN*mN];
+	_resize(n);
 	
 	identity();
 }
 
-Matrix::Matrix( const Matrix& mat )
+Matrix::Matrix( const Matrix& mat ) : mN(0), mCapacity( zhMatrix_InlineSize * zhMatrix_InlineSize ), mMat(mBuffer)
 {
-	mN = mat.size();
-	mMat = new float[mN*mN];
-
-	for( unsigned int i = 0; i < mN; ++i )
-		for( unsigned int j = 0; j < mN; ++j )
-			this->set(i,j,mat.get(i,j));
+	_resize( mat.size() );
+	memcpy( mMat, mat.mMat, mN * mN * sizeof(float) );
 }
 
 Matrix::~Matrix()
 {
-	if( mMat != NULL )
+	if( mMat != mBuffer )
 		delete[] mMat;
 }
 
@@ -326,17 +317,8 @@ Matrix& Matrix::operator =( const Matrix& mat )
 	if( this == &mat )
 		return *this;
 
-	if( mN != mat.size() )
-	{
-		mN = mat.size();
-		if( mMat != NULL )
-			delete[] mMat;
-		mMat = new float[mN*mN];
-	}
-
-	for( unsigned int i = 0; i < mN; ++i )
-		for( unsigned int j = 0; j < mN; ++j )
-			this->set(i,j,mat.get(i,j));
+	_resize( mat.size() );
+	memcpy( mMat, mat.mMat, mN * mN * sizeof(float) );
 
 	return *this;
 }
@@ -356,4 +338,18 @@ Vector Matrix::mul( const Vector& v ) const
 	return *this * v;
 }
 
+void Matrix::_resize( unsigned int n )
+{
+	if( n*n > mCapacity )
+	{
+		// doesn't fit into current storage, reallocate
+		if( mMat != mBuffer )
+			delete[] mMat;
+		mMat = new float[n*n];
+		mCapacity = n*n;
+	}
+
+	mN = n;
+}
+
 }
@@ -0,0 +1,127 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhMoverCurve.h"
+#include "zhBoneAnimationTrack.h"
+
+namespace zh
+{
+
+MoverCurve::MoverCurve()
+: mBoneId(0), mLength(0), mSampleRate(0)
+{
+}
+
+void MoverCurve::build( const BoneAnimationTrack* rootTrack, float length, float sampleRate )
+{
+	zhAssert( rootTrack != NULL );
+	zhAssert( sampleRate > 0 );
+
+	clear();
+
+	mBoneId = rootTrack->getBoneId();
+	mLength = length > 0 ? length : 0;
+
+	// adjust sample rate so that samples are uniform over the whole animation
+	unsigned int num_segs = zhRoundi( mLength * sampleRate );
+	if( num_segs < 1 )
+		num_segs = 1;
+	mSampleRate = mLength > 0 ? num_segs / mLength : 0;
+	mSamples.resize( num_segs + 1 );
+
+	// sample root track
+	KeyFrameCursor cursor;
+	Vector3 scal;
+	for( unsigned int si = 0; si <= num_segs; ++si )
+	{
+		float time = si < num_segs ? mLength * si / num_segs : mLength;
+		Sample& smp = mSamples[si];
+		rootTrack->getInterpolatedTransform( time, smp.mPos, smp.mOrient, scal, &cursor );
+	}
+}
+
+void MoverCurve::clear()
+{
+	mSamples.clear();
+	mLength = 0;
+	mSampleRate = 0;
+}
+
+bool MoverCurve::isEmpty() const
+{
+	return mSamples.empty();
+}
+
+unsigned short MoverCurve::getBoneId() const
+{
+	return mBoneId;
+}
+
+float MoverCurve::getLength() const
+{
+	return mLength;
+}
+
+float MoverCurve::getSampleRate() const
+{
+	return mSampleRate;
+}
+
+unsigned int MoverCurve::getNumSamples() const
+{
+	return mSamples.size();
+}
+
+void MoverCurve::sample( float time, Vector3& pos, Quat& orient ) const
+{
+	zhAssert( !isEmpty() );
+
+	float t;
+	unsigned int si = _getSampleIndex( time, t );
+	const Sample& s1 = mSamples[si];
+	const Sample& s2 = mSamples[si+1];
+
+	pos = s1.mPos + ( s2.mPos - s1.mPos ) * t;
+	orient = s1.mOrient.slerp( s2.mOrient, t );
+}
+
+unsigned int MoverCurve::_getSampleIndex( float time, float& t ) const
+{
+	float ft = time * mSampleRate;
+	if( ft <= 0 )
+	{
+		t = 0;
+		return 0;
+	}
+
+	unsigned int si = (unsigned int)ft;
+	if( si + 1 >= mSamples.size() )
+	{
+		t = 1;
+		return mSamples.size() - 2;
+	}
+
+	t = ft - si;
+	return si;
+}
+
+}
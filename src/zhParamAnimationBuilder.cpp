@@ -89,7 +89,7 @@ void ParamAnimationBuilder::parametrize( const std::vector<AnimationParamSpec>&
 			unsigned int cpi = (unsigned int)u;
 			float t = u - cpi;
 			
-			param_times = tw_curve.getPoint( cpi, t );
+			tw_curve.getPoint( cpi, t, param_times );
 		}
 		else
 		{
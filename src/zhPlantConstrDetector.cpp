@@ -53,15 +53,16 @@ void PlantConstrDetector::detect( unsigned short boneId )
 	float dt = 1.f / zhAnimation_SampleRate; // offset between samples
 
 	float stime = 0, etime; // constr. start and end times
+	KeyFrameCursor kfcur;
 	mSkel->resetToInitialPose();
-	mAnim->apply( mSkel, 0, 1, 1, Animation::EmptyBoneMask );
+	mAnim->apply( mSkel, 0, 1, 1, Animation::EmptyBoneMask, &kfcur );
 	Vector3 last_pos = bone->getWorldPosition(); // bone position in last frame
 	bool bone_stat = true; // flags indicating if the bone is stationary, and if it has been such long enough for there to be a constraint
 	for( unsigned int si = 0; si < num_samples; ++si )
 	{
 		float t = si * dt;
 		mSkel->resetToInitialPose();
-		mAnim->apply( mSkel, t, 1, 1, Animation::EmptyBoneMask );
+		mAnim->apply( mSkel, t, 1, 1, Animation::EmptyBoneMask, &kfcur );
 
 		// get bone position on current frame
 		Vector3 pos = bone->getWorldPosition();
@@ -134,8 +135,9 @@ void PlantConstrDetector::cleanup()
 		std::map< unsigned short, std::vector<Quat> > kfrot;
 		std::map< unsigned short, std::vector<Vector3> > kfscal;
 
+		KeyFrameCursor kfcur;
 		skel->resetToInitialPose();
-		mAnim->apply( mSkel, annot->getStartTime(), 1, 1, Animation::EmptyBoneMask );
+		mAnim->apply( mSkel, annot->getStartTime(), 1, 1, Animation::EmptyBoneMask, &kfcur );
 
 		// initialize IK solver
 		mSolver->setBoneId( bone->getId() );
@@ -149,7 +151,7 @@ void PlantConstrDetector::cleanup()
 			kftimes.push_back(t);
 			
 			skel->resetToInitialPose();
-			mAnim->apply( mSkel, t, 1, 1, Animation::EmptyBoneMask );
+			mAnim->apply( mSkel, t, 1, 1, Animation::EmptyBoneMask, &kfcur );
 			mSolver->solve(mSkel);
 
 			// TODO: how to make foot/hand position parallel to surface?
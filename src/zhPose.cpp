@@ -0,0 +1,344 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhPose.h"
+#include "zhSkeleton.h"
+
+namespace zh
+{
+
+Pose::Pose() : mSkel(NULL)
+{
+}
+
+Pose::Pose( const Skeleton* skel ) : mSkel(NULL)
+{
+	init(skel);
+}
+
+Pose::~Pose()
+{
+}
+
+void Pose::init( const Skeleton* skel )
+{
+	zhAssert( skel != NULL );
+
+	mSkel = skel;
+
+	unsigned int num_bones = skel->getNumBones();
+	mBoneIds.resize(num_bones);
+	mTranslations.resize(num_bones);
+	mRotations.resize(num_bones);
+	mScales.resize(num_bones);
+
+	// build bone ID -> index table
+	unsigned short max_id = 0;
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+	{
+		mBoneIds[bi] = skel->getBoneByIndex(bi)->getId();
+		if( mBoneIds[bi] > max_id )
+			max_id = mBoneIds[bi];
+	}
+	mBoneIndices.assign( num_bones > 0 ? max_id + 1 : 0, UINT_MAX );
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+		mBoneIndices[ mBoneIds[bi] ] = bi;
+
+	reset();
+}
+
+bool Pose::hasLayout( const Skeleton* skel ) const
+{
+	return mSkel == skel && skel != NULL &&
+		mBoneIds.size() == skel->getNumBones();
+}
+
+const Skeleton* Pose::getSkeleton() const
+{
+	return mSkel;
+}
+
+unsigned int Pose::getNumBones() const
+{
+	return mBoneIds.size();
+}
+
+unsigned int Pose::getBoneIndex( unsigned short boneId ) const
+{
+	if( boneId >= mBoneIndices.size() )
+		return UINT_MAX;
+
+	return mBoneIndices[boneId];
+}
+
+unsigned short Pose::getBoneId( unsigned int index ) const
+{
+	zhAssert( index < getNumBones() );
+
+	return mBoneIds[index];
+}
+
+const Vector3& Pose::getTranslation( unsigned int index ) const
+{
+	zhAssert( index < getNumBones() );
+
+	return mTranslations[index];
+}
+
+void Pose::setTranslation( unsigned int index, const Vector3& trans )
+{
+	zhAssert( index < getNumBones() );
+
+	mTranslations[index] = trans;
+}
+
+const Quat& Pose::getRotation( unsigned int index ) const
+{
+	zhAssert( index < getNumBones() );
+
+	return mRotations[index];
+}
+
+void Pose::setRotation( unsigned int index, const Quat& rot )
+{
+	zhAssert( index < getNumBones() );
+
+	mRotations[index] = rot;
+}
+
+const Vector3& Pose::getScale( unsigned int index ) const
+{
+	zhAssert( index < getNumBones() );
+
+	return mScales[index];
+}
+
+void Pose::setScale( unsigned int index, const Vector3& scal )
+{
+	zhAssert( index < getNumBones() );
+
+	mScales[index] = scal;
+}
+
+void Pose::reset()
+{
+	std::fill( mTranslations.begin(), mTranslations.end(), Vector3::Null );
+	std::fill( mRotations.begin(), mRotations.end(), Quat::Identity );
+	std::fill( mScales.begin(), mScales.end(), Vector3(1,1,1) );
+}
+
+void Pose::apply( Skeleton* skel, float weight, float scale ) const
+{
+	zhAssert( skel != NULL && skel->getNumBones() == getNumBones() );
+
+	for( unsigned int bi = 0; bi < mBoneIds.size(); ++bi )
+	{
+		Bone* bone = skel->getBoneByIndex(bi);
+		zhAssert( bone->getId() == mBoneIds[bi] );
+
+		bone->translate( mTranslations[bi] * weight * scale );
+		bone->rotate( Quat().slerp( mRotations[bi], weight ) );
+		bone->scale( Vector3(1,1,1) + ( Vector3(1,1,1) - mScales[bi] ) * weight * scale );
+	}
+}
+
+void Pose::computeWorldTransforms( std::vector<Vector3>& worldPos, std::vector<Quat>& worldOrient,
+								  std::vector<Vector3>& worldScal, float scale ) const
+{
+	zhAssert( mSkel != NULL );
+
+	unsigned int num_bones = mBoneIds.size();
+	const std::vector<unsigned int>& parents = mSkel->getParentIndices();
+	const std::vector<Vector3>& init_pos = mSkel->getInitialPositions();
+	const std::vector<Quat>& init_orient = mSkel->getInitialOrientations();
+	const std::vector<Vector3>& init_scal = mSkel->getInitialScales();
+
+	worldPos.resize(num_bones);
+	worldOrient.resize(num_bones);
+	worldScal.resize(num_bones);
+
+	// parents come before children, so this is a single pass
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+	{
+		Vector3 pos = init_pos[bi] + mTranslations[bi] * scale;
+		Quat orient = init_orient[bi] * mRotations[bi].getNormalized();
+		Vector3 scal = init_scal[bi] * ( Vector3(1,1,1) + ( Vector3(1,1,1) - mScales[bi] ) * scale );
+
+		unsigned int pbi = parents[bi];
+		if( pbi == UINT_MAX )
+		{
+			worldPos[bi] = pos;
+			worldOrient[bi] = orient;
+			worldScal[bi] = scal;
+		}
+		else
+		{
+			worldPos[bi] = worldPos[pbi] + ( worldScal[pbi] * pos ).getRotated( worldOrient[pbi] );
+			worldOrient[bi] = worldOrient[pbi] * orient;
+			worldScal[bi] = worldScal[pbi] * scal;
+		}
+	}
+}
+
+// max. number of power iterations when computing the mean rotation
+static const unsigned int MeanRotationMaxIters = 8;
+
+PoseAccumulator::PoseAccumulator() : mSkel(NULL)
+{
+}
+
+PoseAccumulator::~PoseAccumulator()
+{
+}
+
+void PoseAccumulator::init( const Skeleton* skel )
+{
+	zhAssert( skel != NULL );
+
+	mSkel = skel;
+
+	unsigned int num_bones = skel->getNumBones();
+	mBoneIds.resize(num_bones);
+	mWeights.resize(num_bones);
+	mTranslations.resize(num_bones);
+	mRotMoments.resize( 10 * num_bones );
+	mScales.resize(num_bones);
+
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+		mBoneIds[bi] = skel->getBoneByIndex(bi)->getId();
+
+	reset();
+}
+
+bool PoseAccumulator::hasLayout( const Skeleton* skel ) const
+{
+	return mSkel == skel && skel != NULL &&
+		mBoneIds.size() == skel->getNumBones();
+}
+
+void PoseAccumulator::reset()
+{
+	std::fill( mWeights.begin(), mWeights.end(), 0.f );
+	std::fill( mTranslations.begin(), mTranslations.end(), Vector3::Null );
+	std::fill( mRotMoments.begin(), mRotMoments.end(), 0.f );
+	std::fill( mScales.begin(), mScales.end(), Vector3::Null );
+}
+
+void PoseAccumulator::accumulate( const Pose& pose, float weight, const BoneMask& boneMask )
+{
+	zhAssert( pose.getNumBones() == mBoneIds.size() );
+
+	for( unsigned int bi = 0; bi < mBoneIds.size(); ++bi )
+	{
+		if( boneMask.isMasked( mBoneIds[bi] ) )
+			continue;
+
+		// accumulate weighted outer product of the rotation quaternion,
+		// which is the same for q and -q, so no hemisphere needs to be chosen
+		const Quat& rot = pose.getRotation(bi);
+		float* rm = &mRotMoments[ 10 * bi ];
+		float ww = weight * rot.w, wx = weight * rot.x, wy = weight * rot.y, wz = weight * rot.z;
+		rm[0] += ww * rot.w; rm[1] += ww * rot.x; rm[2] += ww * rot.y; rm[3] += ww * rot.z;
+		rm[4] += wx * rot.x; rm[5] += wx * rot.y; rm[6] += wx * rot.z;
+		rm[7] += wy * rot.y; rm[8] += wy * rot.z;
+		rm[9] += wz * rot.z;
+
+		mWeights[bi] += weight;
+		mTranslations[bi] += pose.getTranslation(bi) * weight;
+		mScales[bi] += pose.getScale(bi) * weight;
+	}
+}
+
+float PoseAccumulator::getWeight( unsigned int index ) const
+{
+	zhAssert( index < mWeights.size() );
+
+	return mWeights[index];
+}
+
+void PoseAccumulator::apply( Skeleton* skel, float scale ) const
+{
+	zhAssert( skel != NULL && skel->getNumBones() == mBoneIds.size() );
+
+	for( unsigned int bi = 0; bi < mBoneIds.size(); ++bi )
+	{
+		float weight = mWeights[bi];
+		if( weight <= 0 )
+			continue;
+
+		Bone* bone = skel->getBoneByIndex(bi);
+		zhAssert( bone->getId() == mBoneIds[bi] );
+
+		Quat rot = _getMeanRotation( &mRotMoments[ 10 * bi ] );
+
+		bone->translate( mTranslations[bi] * scale );
+		bone->rotate( Quat().slerp( rot, weight ) );
+		bone->scale( Vector3(1,1,1) + ( Vector3( weight, weight, weight ) - mScales[bi] ) * scale );
+	}
+}
+
+Quat PoseAccumulator::_getMeanRotation( const float* rotMoments )
+{
+	const float* rm = rotMoments;
+	float m[4][4] =
+	{
+		{ rm[0], rm[1], rm[2], rm[3] },
+		{ rm[1], rm[4], rm[5], rm[6] },
+		{ rm[2], rm[5], rm[7], rm[8] },
+		{ rm[3], rm[6], rm[8], rm[9] }
+	};
+
+	// start from the column with the largest diagonal element,
+	// i.e. the weighted sum of rotations brought into the hemisphere
+	// of the corresponding axis, which is usually close to the mean
+	unsigned int ci = 0;
+	for( unsigned int i = 1; i < 4; ++i )
+		if( m[i][i] > m[ci][ci] )
+			ci = i;
+	float v[4] = { m[0][ci], m[1][ci], m[2][ci], m[3][ci] };
+	float len_sq = v[0]*v[0] + v[1]*v[1] + v[2]*v[2] + v[3]*v[3];
+	if( len_sq <= 0.000001f )
+		return Quat::Identity;
+
+	// mean rotation is the principal eigenvector of the moment matrix,
+	// find it by power iteration
+	for( unsigned int iter = 0; iter < MeanRotationMaxIters; ++iter )
+	{
+		float inv_len = 1.f / sqrt(len_sq);
+		float u[4];
+		for( unsigned int i = 0; i < 4; ++i )
+			u[i] = v[i] * inv_len;
+
+		for( unsigned int i = 0; i < 4; ++i )
+			v[i] = m[i][0] * u[0] + m[i][1] * u[1] + m[i][2] * u[2] + m[i][3] * u[3];
+		len_sq = v[0]*v[0] + v[1]*v[1] + v[2]*v[2] + v[3]*v[3];
+		if( len_sq <= 0.000001f )
+			return Quat( u[0], u[1], u[2], u[3] );
+	}
+
+	Quat rot( v[0], v[1], v[2], v[3] );
+	rot.normalize();
+
+	return rot;
+}
+
+}
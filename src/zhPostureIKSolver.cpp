@@ -51,11 +51,7 @@ namespace zh
 				gi.next();
 				countGoal++;
 			}
-			zh::Skeleton::BoneIterator bi = mSkel -> getBoneIterator();
-			while(!bi.end()){
-				bi.next();
-				countBone++;
-			}
+			countBone = mSkel -> getNumBones();
 			gredient.setDimension(countBone * 3 + 3);
 		}
 		snapshot(0);
@@ -77,65 +73,46 @@ namespace zh
 		}*/
 		//restoreSnapshot(1);
 		GD();
-		zh::Skeleton::BoneIterator bi = mSkel -> getBoneIterator();
-		int counter = 0;
-		if(!bi.end()){
-			Bone* bone = bi.next();
+		// bones are visited in topological order, root first
+		unsigned int numBones = mSkel -> getNumBones();
+		for(unsigned int bi = 0;bi < numBones;++bi){
+			Bone* bone = mSkel -> getBoneByIndex(bi);
 			if(!this ->findBone(bone->getId())){
-				bone ->setPosition(shot[0].rootPosition);
-				bone ->setOrientation(shot[0].rotation[counter]);
+				if(bi == 0)
+					bone ->setPosition(shot[0].rootPosition);
+				bone ->setOrientation(shot[0].rotation[bi]);
 			}
-			counter++;
-		}
-		while(!bi.end()){
-			Bone* bone = bi.next();
-			if(!this ->findBone(bone->getId())){
-				bone ->setOrientation(shot[0].rotation[counter]);
-			}
-			counter++;
 		}
 	}
 	void PostureIKSolver::restoreSnapshot(int index){
-		zh::Skeleton::BoneIterator bi = mSkel -> getBoneIterator();
-		int counter = 0;
-		if(!bi.end()){
-			Bone* bone = bi.next();
-			bone ->setPosition(shot[index].rootPosition);
-			bone ->setOrientation(shot[index].rotation[counter++]);
-		}
-		while(!bi.end()){
-			Bone* bone = bi.next();
-			bone ->setOrientation(shot[index].rotation[counter++]);
-		}	
+		unsigned int numBones = mSkel -> getNumBones();
+		if(numBones > 0)
+			mSkel -> getBoneByIndex(0) ->setPosition(shot[index].rootPosition);
+		for(unsigned int bi = 0;bi < numBones;++bi)
+			mSkel -> getBoneByIndex(bi) ->setOrientation(shot[index].rotation[bi]);
 	}
 	void PostureIKSolver::snapshot(int index){
 		shot[index].rotation.clear();
-		zh::Skeleton::BoneIterator bi = mSkel -> getBoneIterator();
-		if(!bi.end()){
-			Bone* bone = bi.next();
-			shot[index].rootPosition = bone->getPosition();
-			shot[index].rotation.push_back(bone -> getOrientation());
-		}
-		while(!bi.end()){
-			Bone* bone = bi.next();
-			shot[index].rotation.push_back(bone -> getOrientation());
-		}
+		unsigned int numBones = mSkel -> getNumBones();
+		if(numBones > 0)
+			shot[index].rootPosition = mSkel -> getBoneByIndex(0) ->getPosition();
+		for(unsigned int bi = 0;bi < numBones;++bi)
+			shot[index].rotation.push_back(mSkel -> getBoneByIndex(bi) -> getOrientation());
 	}
 	void PostureIKSolver::CGIteration(){
 		
 	}
 	void PostureIKSolver::applyConfiguration(VectorXD& config){
-		zh::Skeleton::BoneIterator bi = mSkel -> getBoneIterator();
-		int counter = 2;
-		if(!bi.end()){
-				Bone* bone = bi.next();
+		unsigned int numBones = mSkel -> getNumBones();
+		if(numBones > 0){
+				Bone* bone = mSkel -> getBoneByIndex(0);
 				bone -> setPosition(bone ->getPosition() + Vector3(config.values[0],config.values[1],config.values[2]));
 				bone -> setOrientation(bone -> getOrientation() * Quat(0,config.values[3],config.values[4],config.values[5]).exp());
 		}
-		while(!bi.end()){
-				Bone* bone = bi.next();
+		for(unsigned int bi = 1;bi < numBones;++bi){
+				Bone* bone = mSkel -> getBoneByIndex(bi);
+				unsigned int counter = bi + 1;
 				bone -> setOrientation(bone -> getOrientation() * Quat(0,config.values[counter * 3],config.values[counter * 3 + 1],config.values[counter * 3 + 2]).exp());
-				counter++;
 		}
 	}
 	double PostureIKSolver::lineSearch(int index, VectorXD& direction){
@@ -183,8 +160,8 @@ namespace zh
 		gredient[1] = 0;
 		gredient[2] = 0;
 		
-		zh::Skeleton::BoneIterator bi = mSkel -> getBoneIterator();
-		int boneCounter = 0;
+		unsigned int numBones = mSkel -> getNumBones();
+		unsigned int boneCounter = 0;
 		//gredient for root position
 		/*GoalConstIterator gi = getGoalConstIterator();
 		while(!gi.end()){
@@ -194,8 +171,7 @@ namespace zh
 			gredient[2] += 2 * (mSkel->getBone(goal.boneId)->getWorldPosition() - goal.position).z;
 		}*/
 
-		bi = mSkel -> getBoneIterator();
-		Bone* bone = bi.next();
+		Bone* bone = mSkel -> getBoneByIndex(0);
 		Vector3 snap = bone ->getPosition();
 		bone -> setPosition(snap + Vector3(step,0,0));
 		gredient[0] = (energy() - energyO) / step;
@@ -205,11 +181,10 @@ namespace zh
 		
 		bone -> setPosition(snap + Vector3(0,0,step));
 		gredient[2] = (energy() - energyO) / step;
-		bi = mSkel -> getBoneIterator();
 		bone -> setPosition(snap);
 
-		while(!bi.end()){
-				Bone* bone = bi.next();
+		for(unsigned int bi = 0;bi < numBones;++bi){
+				Bone* bone = mSkel -> getBoneByIndex(bi);
 				Quat snap = bone -> getOrientation();
 				//x rotation
 				bone -> setOrientation(snap*(Quat(0,step,0,0).exp()));
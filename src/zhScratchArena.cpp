@@ -0,0 +1,157 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhScratchArena.h"
+
+namespace zh
+{
+
+static zhThreadLocal ScratchArena* CurrentArena = NULL;
+
+ScratchArena::ScratchArena( size_t blockSize ) : mCurBlock(0), mOffset(0),
+mUsedSize(0), mCapacity(0), mNumHeapAllocs(0), mGrowing(false)
+{
+	zhAssert( blockSize > 0 );
+
+	_addBlock(blockSize);
+}
+
+ScratchArena::~ScratchArena()
+{
+	zhAssert( CurrentArena != this );
+
+	for( unsigned int block_i = 0; block_i < mBlocks.size(); ++block_i )
+		delete[] mBlocks[block_i].mData;
+}
+
+void* ScratchArena::allocate( size_t size )
+{
+	for(;;)
+	{
+		Block& block = mBlocks[mCurBlock];
+		size_t base = (size_t)block.mData;
+		size_t offset = ( ( base + mOffset + zhScratchArena_Alignment - 1 ) &
+			~(size_t)( zhScratchArena_Alignment - 1 ) ) - base;
+
+		if( offset + size <= block.mSize )
+		{
+			mOffset = offset + size;
+			mUsedSize += size;
+
+			return block.mData + offset;
+		}
+
+		// current block is full, continue in the next one
+		if( mCurBlock + 1 >= mBlocks.size() )
+			_addBlock( std::max( size + zhScratchArena_Alignment, mCapacity ) );
+		++mCurBlock;
+		mOffset = 0;
+	}
+}
+
+void ScratchArena::reset()
+{
+	if( mBlocks.size() > 1 )
+	{
+		// merge blocks, so next time the temporaries fit into one
+		size_t capacity = mCapacity;
+		for( unsigned int block_i = 0; block_i < mBlocks.size(); ++block_i )
+			delete[] mBlocks[block_i].mData;
+		mBlocks.clear();
+		mCapacity = 0;
+		_addBlock(capacity);
+	}
+
+	mCurBlock = 0;
+	mOffset = 0;
+	mUsedSize = 0;
+	mNumHeapAllocs = 0;
+}
+
+size_t ScratchArena::getUsedSize() const
+{
+	return mUsedSize;
+}
+
+size_t ScratchArena::getCapacity() const
+{
+	return mCapacity;
+}
+
+unsigned int ScratchArena::getNumHeapAllocs() const
+{
+	return mNumHeapAllocs;
+}
+
+void ScratchArena::_countHeapAlloc()
+{
+	if( !mGrowing )
+		++mNumHeapAllocs;
+}
+
+ScratchArena* ScratchArena::GetCurrent()
+{
+	return CurrentArena;
+}
+
+void ScratchArena::SetCurrent( ScratchArena* arena )
+{
+	CurrentArena = arena;
+}
+
+void ScratchArena::_addBlock( size_t size )
+{
+	// the arena's own allocations aren't counted
+	mGrowing = true;
+
+	Block block;
+	block.mData = new char[size];
+	block.mSize = size;
+	mBlocks.push_back(block);
+	mCapacity += size;
+
+	mGrowing = false;
+}
+
+}
+
+#if zhAllocTracking_Enabled
+
+void* operator new( size_t size )
+{
+	zh::ScratchArena* arena = zh::ScratchArena::GetCurrent();
+	if( arena != NULL )
+		arena->_countHeapAlloc();
+
+	void* ptr = malloc( size > 0 ? size : 1 );
+	if( ptr == NULL )
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void operator delete( void* ptr ) throw()
+{
+	free(ptr);
+}
+
+#endif
@@ -21,6 +21,7 @@ SOFTWARE.
 ******************************************************************************/
 
 #include "zhSkeleton.h"
+#include "zhScratchArena.h"
 #include "zhLogger.h"
 #include "zhAnimationSystem.h"
 
@@ -143,8 +144,15 @@ Skeleton::Situation Skeleton::Situation::getProjToGround() const
 	return sit;
 }
 
-Skeleton::Skeleton( const std::string& name ) : mName(name), mRoot(NULL)
+#if zhMultiThreading_Enabled
+boost::atomic<unsigned int> Skeleton::msLastVersion(0);
+#else
+unsigned int Skeleton::msLastVersion = 0;
+#endif
+
+Skeleton::Skeleton( const std::string& name ) : mName(name), mRoot(NULL), mTopologyDirty(true)
 {
+	_updateVersion();
 }
 
 Skeleton::~Skeleton()
@@ -204,6 +212,7 @@ Bone* Skeleton::createBone( unsigned short id, const std::string& name )
 	mBonesByName[name] = bone;
 
 	mRoot = NULL;
+	_invalidateTopology();
 
 	return bone;
 }
@@ -225,6 +234,7 @@ void Skeleton::deleteBone( unsigned short id )
 	mBonesById.erase(id);
 	mBonesByName.erase( bone->getName() );
 	delete bone;
+	_invalidateTopology();
 }
 
 void Skeleton::deleteBone( const std::string& name )
@@ -244,6 +254,7 @@ void Skeleton::deleteBone( const std::string& name )
 	mBonesById.erase( bone->getId() );
 	mBonesByName.erase(name);
 	delete bone;
+	_invalidateTopology();
 }
 
 void Skeleton::deleteAllBones()
@@ -255,6 +266,7 @@ void Skeleton::deleteAllBones()
 	mBonesById.clear();
 	mBonesByName.clear();
 	mRoot = NULL;
+	_invalidateTopology();
 }
 
 bool Skeleton::hasBone( unsigned short id ) const
@@ -302,11 +314,79 @@ Skeleton::BoneConstIterator Skeleton::getBoneConstIterator() const
 	return BoneConstIterator( mBonesById );
 }
 
+Bone* Skeleton::getBoneByIndex( unsigned int index ) const
+{
+	_compileTopology();
+	zhAssert( index < mBonesByIndex.size() );
+
+	return mBonesByIndex[index];
+}
+
+unsigned int Skeleton::getParentIndex( unsigned int index ) const
+{
+	_compileTopology();
+	zhAssert( index < mParentIndices.size() );
+
+	return mParentIndices[index];
+}
+
+const std::vector<unsigned int>& Skeleton::getParentIndices() const
+{
+	_compileTopology();
+
+	return mParentIndices;
+}
+
+const std::vector<Vector3>& Skeleton::getInitialPositions() const
+{
+	_compileTopology();
+
+	return mInitPositions;
+}
+
+const std::vector<Quat>& Skeleton::getInitialOrientations() const
+{
+	_compileTopology();
+
+	return mInitOrientations;
+}
+
+const std::vector<Vector3>& Skeleton::getInitialScales() const
+{
+	_compileTopology();
+
+	return mInitScales;
+}
+
 void Skeleton::resetToInitialPose()
 {
-	BoneIterator bone_i = getBoneIterator();
-	while( !bone_i.end() )
-		bone_i.next()->resetToInitialPose();
+	_compileTopology();
+
+	// every bone is reset, so there is no need to propagate dirty flags
+	unsigned int num_bones = mBonesByIndex.size();
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+	{
+		Bone* bone = mBonesByIndex[bi];
+		bone->mPos = mInitPositions[bi];
+		bone->mOrient = mInitOrientations[bi];
+		bone->mScal = mInitScales[bi];
+		bone->mWorldDirty = true;
+	}
+}
+
+void Skeleton::updateWorldTransforms()
+{
+	_compileTopology();
+
+	// parents come before children, so each bone's parent
+	// is already up to date when we get to it
+	unsigned int num_bones = mBonesByIndex.size();
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+	{
+		Bone* bone = mBonesByIndex[bi];
+		if( bone->mWorldDirty )
+			bone->_updateWorldTransform();
+	}
 }
 
 Bone* Skeleton::getBoneByTag( BoneTag tag ) const
@@ -361,6 +441,7 @@ IKSolver* Skeleton::createIKSolver( unsigned long classId, unsigned short id,
 
 	mIKSolversById.insert( make_pair( id, solver ) );
 	mIKSolversByName.insert( make_pair( name, solver ) );
+	_updateVersion();
 
 	return solver;
 }
@@ -381,6 +462,7 @@ void Skeleton::deleteIKSolver( unsigned short id )
 		mIKSolversById.erase(iksi);
 		mIKSolversByName.erase( solver->getName() );
 		delete solver;
+		_updateVersion();
 	}
 }
 
@@ -400,6 +482,7 @@ void Skeleton::deleteIKSolver( const std::string& name )
 		mIKSolversById.erase( solver->getId() );
 		mIKSolversByName.erase(name);
 		delete solver;
+		_updateVersion();
 	}
 }
 
@@ -415,6 +498,7 @@ void Skeleton::deleteAllIKSolvers()
 
 	mIKSolversById.clear();
 	mIKSolversByName.clear();
+	_updateVersion();
 }
 
 bool Skeleton::hasIKSolver( unsigned short id ) const
@@ -465,19 +549,24 @@ Skeleton::IKSolverConstIterator Skeleton::getIKSolverConstIterator() const
 void Skeleton::solveIK()
 {
 	// Get all solvers sorted by their priority
-	std::multimap<unsigned short, IKSolver*> solvers;
+	// (insertion sort, so solvers with equal priority stay in ID order)
+	std::vector< IKSolver*, ScratchAllocator<IKSolver*> > solvers;
+	solvers.reserve( mIKSolversById.size() );
 	IKSolverIterator solver_i = getIKSolverIterator();
 	while( solver_i.hasMore() )
 	{
 		IKSolver* solver = solver_i.next();
-		solvers.insert( std::make_pair( solver->getPriority(), solver ) );
+		unsigned int si = solvers.size();
+		solvers.push_back(solver);
+		for( ; si > 0 && solvers[si-1]->getPriority() > solver->getPriority(); --si )
+			solvers[si] = solvers[si-1];
+		solvers[si] = solver;
 	}
 
 	// Execute the solvers in correct order
-	for( std::multimap<unsigned short, IKSolver*>::iterator psolver_i = solvers.begin();
-		psolver_i != solvers.end(); ++psolver_i )
+	for( unsigned int si = 0; si < solvers.size(); ++si )
 	{
-		IKSolver* solver = psolver_i->second;
+		IKSolver* solver = solvers[si];
 		if( solver->getEnabled() )
 			solver->solve();
 	}
@@ -521,11 +610,13 @@ void Skeleton::_addBoneTag( BoneTag tag, unsigned short boneId )
 	zhAssert( hasBone(boneId) );
 
 	mBonesByTag[tag] = getBone(boneId);
+	_updateVersion();
 }
 
 void Skeleton::_removeBoneTag( BoneTag tag )
 {
 	mBonesByTag.erase(tag);
+	_updateVersion();
 }
 
 void Skeleton::_removeBoneTagsFromBone( unsigned short boneId )
@@ -545,6 +636,70 @@ void Skeleton::_removeBoneTagsFromBone( unsigned short boneId )
 void Skeleton::_removeAllBoneTags()
 {
 	mBonesByTag.clear();
+	_updateVersion();
+}
+
+unsigned int Skeleton::_getVersion() const
+{
+	return mVersion;
+}
+
+void Skeleton::_updateVersion()
+{
+	mVersion = ++msLastVersion;
+}
+
+void Skeleton::_compileTopology() const
+{
+	if( !mTopologyDirty )
+		return;
+
+	unsigned int num_bones = mBonesById.size();
+	mBonesByIndex.clear();
+	mBonesByIndex.reserve(num_bones);
+	mParentIndices.clear();
+	mParentIndices.reserve(num_bones);
+
+	// depth-first traversal from each root bone
+	// (keeps every subtree in a contiguous index range)
+	std::vector<Bone*> stack;
+	for( std::map<unsigned short, Bone*>::const_iterator bone_i = mBonesById.begin();
+		bone_i != mBonesById.end(); ++bone_i )
+	{
+		if( bone_i->second->getParent() != NULL )
+			continue;
+
+		stack.push_back( bone_i->second );
+		while( !stack.empty() )
+		{
+			Bone* bone = stack.back();
+			stack.pop_back();
+
+			bone->mIndex = mBonesByIndex.size();
+			mBonesByIndex.push_back(bone);
+			mParentIndices.push_back( bone->getParent() != NULL ? bone->getParent()->mIndex : UINT_MAX );
+
+			// push children in reverse, so they are visited in order of IDs
+			for( std::map<unsigned short, Bone*>::const_reverse_iterator child_i = bone->mChildrenById.rbegin();
+				child_i != bone->mChildrenById.rend(); ++child_i )
+				stack.push_back( child_i->second );
+		}
+	}
+
+	zhAssert( mBonesByIndex.size() == num_bones );
+
+	mInitPositions.resize(num_bones);
+	mInitOrientations.resize(num_bones);
+	mInitScales.resize(num_bones);
+	for( unsigned int bi = 0; bi < num_bones; ++bi )
+	{
+		const Bone* bone = mBonesByIndex[bi];
+		mInitPositions[bi] = bone->mInitPos;
+		mInitOrientations[bi] = bone->mInitOrient;
+		mInitScales[bi] = bone->mInitScal;
+	}
+
+	mTopologyDirty = false;
 }
 
 }
@@ -0,0 +1,234 @@
+/******************************************************************************
+Copyright (C) 2013 Tomislav Pejsa
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+******************************************************************************/
+
+#include "zhThreadPool.h"
+
+#if zhMultiThreading_Enabled
+#include <boost/bind.hpp>
+#endif
+
+namespace zh
+{
+
+#if zhMultiThreading_Enabled
+
+ThreadPool::ThreadPool( unsigned int numWorkers )
+: mTask(NULL), mBatchId(0), mNumPending(0), mStop(false), mNumWorkers(1)
+{
+	_startWorkers(numWorkers);
+}
+
+ThreadPool::~ThreadPool()
+{
+	_stopWorkers();
+}
+
+void ThreadPool::setNumWorkers( unsigned int numWorkers )
+{
+	_stopWorkers();
+	_startWorkers(numWorkers);
+}
+
+void ThreadPool::run( unsigned int numTasks, Task& task )
+{
+	if( numTasks <= 0 )
+		return;
+
+	if( mNumWorkers <= 1 || numTasks == 1 )
+	{
+		for( unsigned int ti = 0; ti < numTasks; ++ti )
+			task(ti);
+
+		return;
+	}
+
+	// publish the batch before any task can be taken
+	{
+		boost::mutex::scoped_lock lock(mMtx);
+		mTask = &task;
+		mNumPending = numTasks;
+	}
+
+	// split tasks into contiguous ranges, one per worker
+	for( unsigned int wi = 0; wi < mNumWorkers; ++wi )
+	{
+		unsigned int start_ti = numTasks * wi / mNumWorkers,
+			end_ti = numTasks * ( wi + 1 ) / mNumWorkers;
+
+		boost::mutex::scoped_lock lock( mQueues[wi]->mMtx );
+		for( unsigned int ti = start_ti; ti < end_ti; ++ti )
+			mQueues[wi]->mTasks.push_back(ti);
+	}
+
+	// wake up workers
+	{
+		boost::mutex::scoped_lock lock(mMtx);
+		++mBatchId;
+	}
+	mBatchStarted.notify_all();
+
+	// calling thread works as well
+	_runTasks(0);
+
+	// wait for tasks stolen by other workers
+	boost::mutex::scoped_lock lock(mMtx);
+	while( mNumPending > 0 )
+		mBatchFinished.wait(lock);
+	mTask = NULL;
+}
+
+void ThreadPool::_startWorkers( unsigned int numWorkers )
+{
+	mNumWorkers = numWorkers > 1 ? numWorkers : 1;
+	mStop = false;
+
+	for( unsigned int wi = 0; wi < mNumWorkers; ++wi )
+		mQueues.push_back( new WorkQueue() );
+
+	// worker 0 is the calling thread
+	for( unsigned int wi = 1; wi < mNumWorkers; ++wi )
+		mThreads.push_back( new boost::thread( boost::bind( &ThreadPool::_workerLoop, this, wi ) ) );
+}
+
+void ThreadPool::_stopWorkers()
+{
+	{
+		boost::mutex::scoped_lock lock(mMtx);
+		mStop = true;
+	}
+	mBatchStarted.notify_all();
+
+	for( unsigned int thi = 0; thi < mThreads.size(); ++thi )
+	{
+		mThreads[thi]->join();
+		delete mThreads[thi];
+	}
+	mThreads.clear();
+
+	for( unsigned int wi = 0; wi < mQueues.size(); ++wi )
+		delete mQueues[wi];
+	mQueues.clear();
+}
+
+void ThreadPool::_workerLoop( unsigned int workerIndex )
+{
+	unsigned int batch_id = 0;
+
+	for(;;)
+	{
+		// wait for the next batch
+		{
+			boost::mutex::scoped_lock lock(mMtx);
+			while( !mStop && ( mBatchId == batch_id || mNumPending <= 0 ) )
+				mBatchStarted.wait(lock);
+
+			if(mStop)
+				return;
+
+			batch_id = mBatchId;
+		}
+
+		_runTasks(workerIndex);
+	}
+}
+
+bool ThreadPool::_getTask( unsigned int workerIndex, unsigned int& taskIndex )
+{
+	// take from the back of own queue
+	{
+		WorkQueue* queue = mQueues[workerIndex];
+		boost::mutex::scoped_lock lock( queue->mMtx );
+		if( !queue->mTasks.empty() )
+		{
+			taskIndex = queue->mTasks.back();
+			queue->mTasks.pop_back();
+			return true;
+		}
+	}
+
+	// steal from the front of other queues
+	for( unsigned int wi = 1; wi < mNumWorkers; ++wi )
+	{
+		WorkQueue* queue = mQueues[ ( workerIndex + wi ) % mNumWorkers ];
+		boost::mutex::scoped_lock lock( queue->mMtx );
+		if( !queue->mTasks.empty() )
+		{
+			taskIndex = queue->mTasks.front();
+			queue->mTasks.pop_front();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void ThreadPool::_runTasks( unsigned int workerIndex )
+{
+	unsigned int task_index;
+	while( _getTask( workerIndex, task_index ) )
+	{
+		// batch can't finish while this task is pending, so functor is valid
+		Task* task;
+		{
+			boost::mutex::scoped_lock lock(mMtx);
+			task = mTask;
+		}
+
+		(*task)(task_index);
+
+		boost::mutex::scoped_lock lock(mMtx);
+		if( --mNumPending <= 0 )
+			mBatchFinished.notify_all();
+	}
+}
+
+#else
+
+ThreadPool::ThreadPool( unsigned int numWorkers )
+: mNumWorkers(1)
+{
+}
+
+ThreadPool::~ThreadPool()
+{
+}
+
+void ThreadPool::setNumWorkers( unsigned int numWorkers )
+{
+	// no worker threads without multi-threading support
+	mNumWorkers = 1;
+}
+
+void ThreadPool::run( unsigned int numTasks, Task& task )
+{
+	for( unsigned int ti = 0; ti < numTasks; ++ti )
+		task(ti);
+}
+
+#endif
+
+unsigned int ThreadPool::getNumWorkers() const
+{
+	return mNumWorkers;
+}
+
+}
@@ -27,35 +27,29 @@ SOFTWARE.
 namespace zh
 {
 
-Vector::Vector()
+Vector::Vector() : mN(0), mCapacity(zhVector_InlineSize), mV(mBuffer)
 {
-	mN = 0;
-	mV = NULL;
 }
 
-Vector::Vector( unsigned int n, float x )
+Vector::Vector( unsigned int n, float x ) : mN(0), mCapacity(zhVector_InlineSize), mV(mBuffer)
 {
 	zhAssert( n > 0 );
 
-	mN = n;
-	mV = new float[n];
+	_resize(n);
 
 	for( unsigned int i = 0; i < n; ++i )
 		mV[i] = x;
 }
 
-Vector::Vector( const Vector& v )
+Vector::Vector( const Vector& v ) : mN(0), mCapacity(zhVector_InlineSize), mV(mBuffer)
 {
-	mN = v.size();
-	mV = new float[mN];
-
-	for( unsigned int i = 0; i < mN; ++i )
-		this->set( i, v.get(i) );
+	_resize( v.size() );
+	memcpy( mV, v.mV, mN * sizeof(float) );
 }
 
 Vector::~Vector()
 {
-	if( mV != NULL )
+	if( mV != mBuffer )
 		delete[] mV;
 }
 
@@ -210,7 +204,8 @@ Vector Vector::operator *( float s ) const
 
 void Vector::operator *=( float s )
 {
-	*this = *this * s;
+	for( unsigned int i = 0; i < mN; ++i )
+		mV[i] *= s;
 }
 
 Vector Vector::operator /( float s ) const
@@ -225,7 +220,8 @@ Vector Vector::operator /( float s ) const
 
 void Vector::operator /=( float s )
 {
-	*this = *this / s;
+	for( unsigned int i = 0; i < mN; ++i )
+		mV[i] /= s;
 }
 
 Vector Vector::operator +( const Vector& v ) const
@@ -242,7 +238,10 @@ Vector Vector::operator +( const Vector& v ) const
 
 void Vector::operator +=( const Vector& v )
 {
-	*this = *this + v;
+	zhAssert( mN == v.size() );
+
+	for( unsigned int i = 0; i < mN; ++i )
+		mV[i] += v.mV[i];
 }
 
 Vector Vector::operator -( const Vector& v ) const
@@ -259,7 +258,10 @@ Vector Vector::operator -( const Vector& v ) const
 
 void Vector::operator -=( const Vector& v )
 {
-	*this = *this - v;
+	zhAssert( mN == v.size() );
+
+	for( unsigned int i = 0; i < mN; ++i )
+		mV[i] -= v.mV[i];
 }
 
 Vector Vector::operator *( const Vector& v ) const
@@ -303,16 +305,8 @@ Vector& Vector::operator =( const Vector& v )
 	if( this == &v )
 		return *this;
 
-	if( mN != v.size() )
-	{
-		mN = v.size();
-		if( mV != NULL )
-			delete[] mV;
-		mV = new float[mN];
-	}
-
-	for( unsigned int i = 0; i < mN; ++i )
-		this->set( i, v.get(i) );
+	_resize( v.size() );
+	memcpy( mV, v.mV, mN * sizeof(float) );
 
 	return *this;
 }
@@ -324,7 +318,8 @@ bool Vector::equals( const Vector& v ) const
 
 Vector& Vector::negate()
 {
-	*this = -*this;
+	for( unsigned int i = 0; i < mN; ++i )
+		mV[i] = -mV[i];
 
 	return *this;
 }
@@ -371,4 +366,18 @@ float Vector::dot( const Vector& v ) const
 	return d;
 }
 
+void Vector::_resize( unsigned int n )
+{
+	if( n > mCapacity )
+	{
+		// doesn't fit into current storage, reallocate
+		if( mV != mBuffer )
+			delete[] mV;
+		mV = new float[n];
+		mCapacity = n;
+	}
+
+	mN = n;
+}
+
 }
@@ -266,6 +266,9 @@ bool ZHALoader::parseAnimation( rapidxml::xml_node<>* node )
 	{
 		if( !parseTracks(child) )
 			return false;
+
+		// key-frames are final, build interpolation splines
+		mAnim->buildInterpSplines();
 	}
 
 	child = node->first_node( "Annotations" );
@@ -433,10 +436,7 @@ bool ZHALoader::parseTransformKeyFrame( rapidxml::xml_node<>* node, BoneAnimatio
 
 	// assign attribute values:
 
-	TransformKeyFrame* tkf = static_cast<TransformKeyFrame*>( track->createKeyFrame(time) );
-	tkf->setTranslation(trans);
-	tkf->setRotation(rot);
-	tkf->setScale(scal);
+	track->createTransformKeyFrame( time, trans, rot, scal );
 
 	return true;
 }